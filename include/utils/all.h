@@ -27,6 +27,7 @@
 
 #include "log.h"
 #include "mm.h"
+#include "linear.h"
 
 #ifdef LUCUR_CLOCK_API
 #include "clock.h"
@@ -0,0 +1,46 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_UTILS_LINEAR_H
+#define DLU_UTILS_LINEAR_H
+
+/**
+* [Frame Arena] Linear allocator for data that only lives for one frame
+* Each of the frame_cnt frames (frames in flight) gets its own region of bytes.
+* Allocating bumps a pointer, resetting a frame releases everything in it at once.
+*/
+dlu_frame_arena *dlu_frame_arena_create(uint32_t frame_cnt, size_t bytes);
+
+/**
+* Returns 16 byte aligned memory from the region of frame (modulo frame count)
+* Memory isn't zeroed. NULL is returned when the region is exhausted
+*/
+void *dlu_frame_alloc(dlu_frame_arena *fa, uint32_t frame, size_t bytes);
+
+/* Release every allocation made from a frame's region. Call at the start of the frame */
+void dlu_frame_reset(dlu_frame_arena *fa, uint32_t frame);
+
+void dlu_frame_arena_destroy(dlu_frame_arena *fa);
+
+#endif
@@ -27,11 +27,55 @@
 
 /* [One Time Memory Allocater] For creating large memory blocks once */
 bool dlu_otma(dlu_block_type type, dlu_otma_mems ma);
-/* [One Time Buffer Allocater] For sub-allocating blocks of memory from large block */
+/**
+* [One Time Buffer Allocater] For sub-allocating blocks of memory from large block
+* Calling it again for an array that already exists grows the array when arr_size is larger.
+* Capacity at least doubles, existing indices stay valid but the array may move.
+*/
 bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size);
 
+/* Call dlu_print_mem_stats(3) first to report how much of the blocks was used */
 void dlu_release_blocks();
 
+/* Counters for the block of a type (private or shared), cheap enough to query every frame */
+bool dlu_get_mem_stats(dlu_block_type type, dlu_mem_stats *stats);
+void dlu_print_mem_stats(dlu_block_type type);
+
+/**
+* [Arena] For allocating from one thread without touching the process wide blocks
+* DLU_LARGE_BLOCK_PRIV/DLU_LARGE_BLOCK_SHARED: Arena maps its own large block
+* DLU_SMALL_BLOCK_PRIV: Arena is carved from the dlu_otma(3) large block
+* DLU_SMALL_BLOCK_SHARED isn't permitted, the arena's state would be exported with the block
+* The arena takes the dlu_block_flags the dlu_otma(3) block of its type was created with, none
+* after dlu_release_blocks(3)
+*/
+dlu_arena *dlu_arena_create(dlu_block_type type, size_t bytes);
+
+/* Bind arena to the calling thread. dlu_otba(3) then allocates from it, NULL unbinds */
+void dlu_arena_bind(dlu_arena *arena);
+
+void dlu_arena_destroy(dlu_arena *arena);
+
+/**
+* [Shared Block] The DLU_LARGE_BLOCK_SHARED block is backed by a memfd. Send it over a
+* unix socket (SCM_RIGHTS) so another process can map the same memory. Addresses differ
+* between processes, so pass offsets from dlu_shared_offset(3) and convert them back
+* with dlu_shared_ptr(3). Chunks added by DLU_BLOCK_CHAINED aren't shared.
+* The memfd only holds allocation data, the block is always DLU_BLOCK_HEADERLESS and its
+* metadata stays private to the exporting process. Any process the block is sent to can
+* write to it, so both sides must treat its contents (offsets included) as untrusted input
+* and validate them before use.
+*/
+bool dlu_export_shared_block(int sock);
+
+/* Returns the start of the mapped block and its size through bytes, NULL on failure */
+void *dlu_import_shared_block(int sock, size_t *bytes);
+void dlu_detach_shared_block(void *addr, size_t bytes);
+
+/* Offset of a DLU_SMALL_BLOCK_SHARED allocation from the start of the shared block's data */
+size_t dlu_shared_offset(void *ptr);
+void *dlu_shared_ptr(void *addr, size_t offset);
+
 #ifdef DEV_ENV
 void dlu_print_mb(dlu_block_type type);
 #endif
@@ -39,6 +83,15 @@ void dlu_print_mb(dlu_block_type type);
 #ifdef INAPI_CALLS
 /* Function is reserve for one time use. Only used when allocating space for struct members */
 void *dlu_alloc(dlu_block_type type, size_t bytes);
+/* Same as dlu_alloc() with the returned address a multiple of align. Power of two up to page size */
+void *dlu_alloc_aligned(dlu_block_type type, size_t bytes, size_t align);
+/* Release a small block so later allocations can reuse it */
+void dlu_free(dlu_block_type type, void *ptr);
+void *dlu_realloc(dlu_block_type type, void *ptr, size_t bytes);
+
+void *dlu_arena_alloc(dlu_arena *arena, size_t bytes);
+void dlu_arena_free(dlu_arena *arena, void *ptr);
+void *dlu_arena_realloc(dlu_arena *arena, void *ptr, size_t bytes);
 #endif
 
 #endif
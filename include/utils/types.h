@@ -43,6 +43,29 @@ typedef enum _dlu_block_type {
   DLU_SMALL_BLOCK_SHARED = 0x0004
 } dlu_block_type;
 
+/**
+* Flags passed to dlu_otma(3) through dlu_otma_mems
+* DLU_BLOCK_CHAINED: Map a new chunk (twice the size of the last) when the large block is exhausted
+* DLU_BLOCK_HEADERLESS: Small blocks carry no metadata. Sizes are rounded to a size class
+*                       and tracked in a side table (one byte per 16 bytes). Limited to 2MB blocks
+* DLU_BLOCK_POPULATE: Fault every page in when the large block is mapped
+* DLU_BLOCK_HUGE_PAGES: Back large blocks with 2MB pages, transparent huge pages if none are reserved
+* DLU_BLOCK_MLOCK: Lock large blocks in memory so they are never paged out
+*/
+typedef enum _dlu_block_flags {
+  DLU_BLOCK_CHAINED = 0x0001,
+  DLU_BLOCK_HEADERLESS = 0x0002,
+  DLU_BLOCK_POPULATE = 0x0004,
+  DLU_BLOCK_HUGE_PAGES = 0x0008,
+  DLU_BLOCK_MLOCK = 0x0010
+} dlu_block_flags;
+
+/* Opaque handle to an arena a thread can allocate from, see dlu_arena_create(3) */
+typedef struct _dlu_arena dlu_arena;
+
+/* Opaque handle to per-frame linear allocators, see dlu_frame_arena_create(3) */
+typedef struct _dlu_frame_arena dlu_frame_arena;
+
 typedef enum _dlu_data_type {
   DLU_SC_DATA = 0x0000,
   DLU_GP_DATA = 0x0001,
@@ -81,8 +104,36 @@ typedef struct _dlu_otma_mems {
   uint32_t drmc_cnt;  /* dlu_drm_core struct count */
   uint32_t dod_cnt;    /* Device output_data struct count */
   uint32_t dob_cnt;    /* Device Output Buffer Count */
+  uint32_t ala_cnt;     /* aligned allocation count, see dlu_alloc_aligned(3) */
+  uint32_t ala_bytes;  /* bytes in each aligned allocation */
+  uint32_t ala_align;  /* alignment of each aligned allocation */
+  uint32_t flags;       /* dlu_block_flags */
 } dlu_otma_mems;
 
+/* Amount of dlu_data_type values, size of dlu_mem_stats otba_bytes */
+#define DLU_OTBA_TYPE_CNT 13
+
+/**
+* Usage counters of a dlu_otma(3) block, see dlu_get_mem_stats(3)
+* reserved   | Bytes mapped for the large block and any chained chunks
+* used       | Bytes held by live small blocks, metadata included
+* free       | Bytes left in the current chunk plus bytes of released small blocks
+* peak       | Highest value of used
+* alloc_cnt  | Amount of small block allocations
+* free_cnt   | Amount of small blocks released
+* otba_bytes | Bytes held by dlu_otba(3) arrays per dlu_data_type, in the order the enum declares them.
+*              Arrays that grew only count their current size, rounded up to its size class
+*/
+typedef struct _dlu_mem_stats {
+  size_t reserved;
+  size_t used;
+  size_t free;
+  size_t peak;
+  uint64_t alloc_cnt;
+  uint64_t free_cnt;
+  size_t otba_bytes[DLU_OTBA_TYPE_CNT];
+} dlu_mem_stats;
+
 #ifdef INAPI_CALLS
 typedef enum _dlu_err_msg_type {
   DLU_DR_INSTANCE_PROC_ADDR_ERR = 0x0001,
@@ -104,6 +155,13 @@ typedef enum _dlu_err_msg_type {
   DLU_VKCOMP_CMD_POOL = 0x010C,
   DLU_VKCOMP_CMD_BUFFS = 0x010D,
   DLU_VKCOMP_DEVICE_NOT_ASSOC = 0x010E,
+  DLU_VKCOMP_MEM_NOT_MAPPED = 0x010F,
+  DLU_VKCOMP_UPLOAD = 0x0110,
+  DLU_VKCOMP_BINDLESS = 0x0111,
+  DLU_VKCOMP_FRAMES = 0x0112,
+  DLU_VKCOMP_RECORDER = 0x0113,
+  DLU_VKCOMP_TIMELINE = 0x0114,
+  DLU_VKCOMP_PROFILER = 0x0115,
   DLU_BUFF_NOT_ALLOC = 0x0FFC,
   DLU_OP_NOT_PERMITED = 0x0FFD,
   DLU_ALLOC_FAILED = 0x0FFE,
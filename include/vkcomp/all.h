@@ -35,6 +35,15 @@
 #include "utils.h"
 #include "vlayer.h"
 #include "vk_calls.h"
+#include "mem.h"
+#include "ring.h"
+#include "upload.h"
+#include "alloc.h"
+#include "bindless.h"
+#include "frame.h"
+#include "record.h"
+#include "timeline.h"
+#include "profile.h"
 
 #ifdef INAPI_CALLS
 #include "device.h"
@@ -0,0 +1,48 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_ALLOC_H
+#define DLU_VKCOMP_ALLOC_H
+
+/**
+* [Host Allocation Tracking] Installs VkAllocationCallbacks that account every host allocation
+* the driver makes by VkSystemAllocationScope. Must be called before dlu_create_instance(3),
+* every object vkcomp creates and destroys afterwards is given the callbacks.
+* arena_size: Bytes of a dedicated dlu_arena(3) command and object scope allocations are served
+*             from, malloc is used once it's full. 0 serves every scope from malloc
+* limit:      Upper bound of live driver bytes. Allocations that would pass it fail and the driver
+*             returns VK_ERROR_OUT_OF_HOST_MEMORY. 0 for no limit
+*/
+VkResult dlu_vk_host_alloc_create(vkcomp *app, size_t arena_size, size_t limit);
+
+/* Counters of one allocation scope, cheap enough to query every frame */
+bool dlu_vk_host_alloc_get_stats(vkcomp *app, VkSystemAllocationScope scope, dlu_vk_host_alloc_stats *stats);
+void dlu_vk_host_alloc_print_stats(vkcomp *app);
+
+#ifdef INAPI_CALLS
+/* Called by dlu_freeup_vk(3) after the instance is destroyed */
+void dlu_vk_host_alloc_destroy(vkcomp *app);
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_BINDLESS_H
+#define DLU_VKCOMP_BINDLESS_H
+
+/**
+* [Bindless Rendering] Every texture of a logical device lives in one descriptor indexed array
+* of combined image samplers (set 0, binding 0), bound once per command buffer. Draws select
+* their texture with an index and read vertex data through a buffer device address, both
+* passed as push constants, so no descriptor set or vertex buffer is bound per draw.
+* The logical device must enable VK_EXT_descriptor_indexing and, for vertex pulling,
+* VK_KHR_buffer_device_address. Buffers then need VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+*
+* layout(set = 0, binding = 0) uniform sampler2D textures[];
+* layout(push_constant) uniform draw { Vertices vertices; uint texture; uint instance; };
+* ... texture(textures[nonuniformEXT(texture)], uv)
+*/
+
+/**
+* Create the table of a logical device with room for capacity textures, at most
+* maxDescriptorSetUpdateAfterBindSampledImages and maxPerStageDescriptorUpdateAfterBindSamplers
+* (and their sampler/sampled image counterparts). stages are the shader stages that
+* index the table and read the push constants
+*/
+VkResult dlu_vk_bindless_create(vkcomp *app, uint32_t cur_ld, uint32_t capacity, VkShaderStageFlags stages);
+
+/**
+* Put cur_tex's view and sampler into a free slot and return the slot, UINT32_MAX if the table is full.
+* The table is update after bind, slots can be filled while command buffers using it are pending
+*/
+uint32_t dlu_vk_bindless_add_texture(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex, VkImageLayout layout);
+
+/* Point an existing slot at cur_tex, i.e after an evicted texture was recreated */
+VkResult dlu_vk_bindless_set_texture(vkcomp *app, uint32_t cur_ld, uint32_t slot, uint32_t cur_tex, VkImageLayout layout);
+
+/**
+* When a texture is evicted (see dlu_vk_evict_lru_texture(3)) its slots are pointed at cur_tex,
+* which is never evicted itself, so they stay valid to index until the texture is recreated.
+* Without a fallback the slots of an evicted texture are given back
+*/
+VkResult dlu_vk_bindless_set_fallback(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex, VkImageLayout layout);
+
+/* Give a slot back. Frames in flight must no longer index it, a slot that is already free is ignored */
+void dlu_vk_bindless_remove(vkcomp *app, uint32_t cur_ld, uint32_t slot);
+
+/**
+* Create the pipeline layout of cur_gpd with the table as set 0 and a push_size bytes
+* push constant range, sizeof(dlu_vk_bindless_draw) for the default block
+*/
+VkResult dlu_vk_bindless_pipeline_layout(vkcomp *app, uint32_t cur_ld, uint32_t cur_gpd, uint32_t push_size);
+
+/* Bind the table once per command buffer, before the draws of cur_gpd's pipelines */
+void dlu_vk_bindless_bind(vkcomp *app, uint32_t cur_gpd, VkCommandBuffer cmd_buff, VkPipelineBindPoint bind_point);
+
+/* Per draw: push size bytes of data (usually a dlu_vk_bindless_draw) at offset 0 */
+void dlu_vk_bindless_push(vkcomp *app, uint32_t cur_gpd, VkCommandBuffer cmd_buff, uint32_t size, const void *data);
+
+#ifdef INAPI_CALLS
+/* Called before the logical device is destroyed */
+void dlu_vk_bindless_destroy(vkcomp *app, uint32_t cur_ld);
+
+/* Called before cur_tex's view is destroyed by eviction, points its slots at the fallback or gives them back */
+void dlu_vk_bindless_evict_texture(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex);
+
+/* Whether cur_tex is the table's fallback texture, which is never evicted */
+bool dlu_vk_bindless_is_fallback(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex);
+#endif
+
+#endif
@@ -60,7 +60,9 @@ VkResult dlu_create_physical_device(
 * Almost every operation in Vulkan, from submitting command buffers
 * to presenting images to a surface, requires commands to be submitted
 * to a hardware queue. This will create multiple queue family indices
-* that are supported by a device.
+* that are supported by a device. For VK_QUEUE_TRANSFER_BIT a family without graphics
+* or compute support is preferred. Its queue only exists if a VkDeviceQueueCreateInfo
+* for tfam_idx is passed to dlu_create_logical_device(3) when it differs from gfam_idx.
 */
 VkBool32 dlu_create_queue_families(vkcomp *app, uint32_t cur_pd, VkQueueFlagBits vkqfbits);
 
@@ -68,7 +70,11 @@ VkBool32 dlu_create_queue_families(vkcomp *app, uint32_t cur_pd, VkQueueFlagBits
 * After selecting a physical device to use.
 * Set up a logical device to interface with your physical device
 * This function is also used to set Vulkan Device Level Extensions
-* that entail what a device does
+* that entail what a device does. VK_KHR_buffer_device_address and
+* VK_EXT_descriptor_indexing get the features bindless rendering needs enabled,
+* VK_KHR_timeline_semaphore the one dlu_vk_timeline_create(3) needs. Their support is
+* queried first, which takes Vulkan 1.1 or VK_KHR_get_physical_device_properties2 on the
+* instance. Missing features are logged and VK_ERROR_FEATURE_NOT_PRESENT is returned
 */
 VkResult dlu_create_logical_device(
   vkcomp *app,
@@ -114,6 +120,9 @@ VkResult dlu_create_swap_chain(
 * Function will create the VkImage handle for the depth buffer
 * Allocate memory and bind that memory to the VkImage Handle
 * Then create the corresponding image view
+* Depth is rarely read after the render pass. Add VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+* to img_info->usage (with VK_ATTACHMENT_STORE_OP_DONT_CARE) to back it with
+* VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT memory when the device has such a type
 */
 VkResult dlu_create_depth_buff(
   vkcomp *app,
@@ -123,10 +132,29 @@ VkResult dlu_create_depth_buff(
   VkMemoryPropertyFlags requirements_mask
 );
 
+/**
+* Multisampled color target shared by every swap chain image, img_info->samples > 1.
+* Render into it and resolve into the swap chain image within the render pass via
+* VkSubpassDescription pResolveAttachments. Like the depth buffer it should be
+* VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT with VK_ATTACHMENT_STORE_OP_DONT_CARE,
+* then only the resolved image is ever written to memory
+*/
+VkResult dlu_create_msaa_color_buff(
+  vkcomp *app,
+  uint32_t cur_scd,
+  VkImageCreateInfo *img_info,
+  VkImageViewCreateInfo *ivi,
+  VkMemoryPropertyFlags requirements_mask
+);
+
 /**
 * Function creates buffers like a uniform buffer so that shaders can access
 * in a read-only fashion constant parameter data. Function also
 * creates buffers like a vertex buffer so that it's visible to the CPU
+* The memory type picked has every flag in requirements_mask. Request
+* VK_MEMORY_PROPERTY_HOST_CACHED_BIT without HOST_COHERENT for fast readbacks,
+* then call dlu_vk_invalidate_mem(3) before reading
+* With VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT buff_data[cur_bd].addr is set
 */
 VkResult dlu_create_vk_buffer(
   vkcomp *app,
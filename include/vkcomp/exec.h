@@ -31,6 +31,28 @@ VkCommandBuffer dlu_exec_begin_single_time_cmd_buff(vkcomp *app, uint32_t cur_po
 /* Function submits and closes one time VkCommandBuffer to the graphics queue */
 VkResult dlu_exec_end_single_time_cmd_buff(vkcomp *app, uint32_t cur_pool, VkCommandBuffer *cmd_buff);
 
+/**
+* Batched alternative to the single time functions above. Returns the command buffer
+* of the batch being recorded, starting one if needed. Every call before the next
+* dlu_exec_submit_batch(3) returns the same command buffer, so any amount of copies
+* and barriers end up in one submission. Only blocks if DLU_EXEC_BATCH_CNT batches
+* are still in flight. Pools created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT
+* reset and reuse each slot's command buffer, others allocate a new one per batch
+*/
+VkCommandBuffer dlu_exec_begin_batch(vkcomp *app, uint32_t cur_pool);
+
+/**
+* Submit the batch being recorded to the graphics queue without waiting on it.
+* ticket is set to the batch's ticket, pass it to dlu_exec_wait_batch(3) once results are needed
+*/
+VkResult dlu_exec_submit_batch(vkcomp *app, uint32_t cur_pool, uint64_t *ticket);
+
+/* Whether a submitted batch finished executing, never blocks */
+bool dlu_exec_batch_done(vkcomp *app, uint32_t cur_pool, uint64_t ticket);
+
+/* Block until a batch finishes executing, submitting it first if it's still being recorded */
+VkResult dlu_exec_wait_batch(vkcomp *app, uint32_t cur_pool, uint64_t ticket);
+
 /**
 * cur_pool: Function uses one time command buffer allocate/submit
 * src_bd: must be a valid VkBuffer
@@ -108,6 +130,36 @@ VkResult dlu_exec_begin_cmd_buffs(
 
 VkResult dlu_exec_stop_cmd_buffs(vkcomp *app, uint32_t cur_pool, uint32_t cur_scd); 
 
+/**
+* Record once replay for scenes that draw the same thing every frame. Returns
+* cmd_data[cur_pool].cmd_buffs[cur_img] ready to submit, only re-recording it when
+* dlu_exec_mark_dirty(3) was called or the swap chain changed since it was last recorded.
+* A re-recorded buffer gets cur_gpd's render pass on cur_img's framebuffer with record
+* filling in its contents. Always waits on sc_data[cur_scd].syncs[cur_img].fence.render, so
+* the buffer must be submitted with cur_img as synci (see dlu_queue_graphics_queue(3))
+* and the fence reset before that. The pool must be created with
+* VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, otherwise it fails without touching the buffer
+*/
+VkResult dlu_exec_record_cached(
+  vkcomp *app,
+  uint32_t cur_pool,
+  uint32_t cur_scd,
+  uint32_t cur_gpd,
+  uint32_t cur_img,
+  VkRect2D render_area,
+  uint32_t clearValueCount,
+  const VkClearValue *pClearValues,
+  dlu_exec_record_fn record,
+  void *data,
+  VkCommandBuffer *cmd_buff
+);
+
+/**
+* Anything a cached command buffer binds or draws changed (pipelines, descriptor sets,
+* vertex buffers, draw counts), every image's buffer gets re-recorded on next use
+*/
+void dlu_exec_mark_dirty(vkcomp *app, uint32_t cur_pool);
+
 void dlu_exec_cmd_draw(
   vkcomp *app,
   uint32_t cur_pool,
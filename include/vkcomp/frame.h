@@ -0,0 +1,80 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_FRAME_H
+#define DLU_VKCOMP_FRAME_H
+
+/**
+* [Frame Engine] Records and submits a swap chain's frames with frame_cnt frames in flight,
+* the CPU records frame N + 1 while the GPU renders frame N. Frame f (0 <= f < frame_cnt)
+* owns cmd_data[cur_pool].cmd_buffs[f], the acquire semaphore and render fence of
+* sc_data[cur_scd].syncs[f] (the fence ring) and slice f of an optional uniform ring.
+* Each swap chain image signals its own syncs[img].sem.render for presentation.
+* frame_cnt is at most the swap chain image count. The pool must be created with
+* VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, buffers via dlu_create_cmd_buffs(3)
+* and syncs via dlu_create_syncs(3). Pass UINT32_MAX as cur_ubd for no uniform ring,
+* a ring needs at least frame_cnt slices.
+* Textures of the device aren't evicted until frame_cnt + 1 frames after their last use,
+* with several frame engines on a device its frame advances once each of them ended a frame
+*/
+VkResult dlu_vk_frame_create(vkcomp *app, uint32_t cur_scd, uint32_t cur_pool, uint32_t frame_cnt, uint32_t cur_ubd);
+
+/**
+* Wait until the GPU is done with the frame that last used the next slot, acquire a swap chain
+* image and begin the slot's command buffer. cur_buff is the frame's command buffer index in
+* cmd_data[cur_pool] for the dlu_bind and dlu_exec_cmd functions, cur_img the acquired image.
+* The uniform ring's slice of the frame is ready for dlu_uniform_ring_push(3).
+* Returns VK_ERROR_OUT_OF_DATE_KHR when the swap chain has to be recreated
+*/
+VkResult dlu_vk_frame_begin(vkcomp *app, uint32_t cur_scd, uint32_t *cur_buff, uint32_t *cur_img);
+
+/* Begin cur_gpd's render pass on the acquired image's framebuffer */
+void dlu_vk_frame_begin_render_pass(
+  vkcomp *app,
+  uint32_t cur_scd,
+  uint32_t cur_gpd,
+  VkRect2D render_area,
+  uint32_t clearValueCount,
+  const VkClearValue *pClearValues,
+  VkSubpassContents contents
+);
+
+void dlu_vk_frame_stop_render_pass(vkcomp *app, uint32_t cur_scd);
+
+/**
+* End the frame's command buffer, submit it to the graphics queue once the image is
+* acquired and queue the image for presentation. Never waits on the GPU.
+* On failure the frame is dropped, its fence stays signaled and the slot is begun again
+*/
+VkResult dlu_vk_frame_end(vkcomp *app, uint32_t cur_scd);
+
+/* Block until every frame in flight finished rendering, i.e before recreating the swap chain */
+VkResult dlu_vk_frame_wait_idle(vkcomp *app, uint32_t cur_scd);
+
+#ifdef INAPI_CALLS
+/* Waits on every frame in flight then frees the frame engine */
+void dlu_vk_frame_destroy(vkcomp *app, uint32_t cur_scd);
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_MEM_H
+#define DLU_VKCOMP_MEM_H
+
+/**
+* [Device Memory Pool] Resources are bound to ranges of large VkDeviceMemory blocks
+* instead of getting a VkDeviceMemory object each. Blocks are split with a buddy allocator,
+* one set of blocks per memory type. Linear (buffers, linear images) and optimal tiling
+* resources never share a block, so bufferImageGranularity never has to be padded for.
+* Requests larger than half a block and lazily allocated memory get a dedicated VkDeviceMemory object.
+* Host visible memory stays mapped for as long as it's allocated.
+*/
+#define DLU_VK_MEM_BLOCK_SHIFT 26
+#define DLU_VK_MEM_BLOCK_SIZE (1UL << DLU_VK_MEM_BLOCK_SHIFT)
+
+/**
+* Sub-allocate memory for a resource from a memory type with every flag in requirements_mask.
+* Nothing is bound, the caller binds the resource to mem at sub->offset.
+* If the memory type is host visible sub->map points to the start of the range.
+*/
+VkResult dlu_vk_mem_alloc(
+  vkcomp *app,
+  uint32_t cur_ld,
+  VkMemoryRequirements *mem_reqs,
+  VkMemoryPropertyFlags requirements_mask,
+  bool linear,
+  VkDeviceMemory *mem,
+  dlu_vk_suballoc *sub
+);
+
+/* Hand a range back to its block, dedicated VkDeviceMemory objects are freed */
+void dlu_vk_mem_free(vkcomp *app, uint32_t cur_ld, VkDeviceMemory mem, dlu_vk_suballoc *sub);
+
+/* Free every block of a logical device's pool. Resources bound to them must already be destroyed */
+void dlu_vk_mem_pool_destroy(vkcomp *app, uint32_t cur_ld);
+
+/**
+* [Memory Budget] Every VkDeviceMemory object vkcomp allocates is counted against its heap.
+* Before new memory is allocated from a heap that would go over budget, empty pool blocks
+* are given back and the logical device's eviction policy is run until it fits. Eviction
+* stops early once an evicted resource neither gave memory back nor made room in a block.
+* With VK_EXT_memory_budget enabled on the logical device (needs the instance extension
+* VK_KHR_get_physical_device_properties2) usage and budget come from the driver, otherwise
+* usage is what vkcomp allocated and the budget DLU_VK_MEM_BUDGET_PERCENT of the heap's size.
+*/
+#define DLU_VK_MEM_BUDGET_PERCENT 80
+
+/**
+* Frames a texture must go unused for before it can be evicted, more than the frames in flight.
+* Only used without a frame engine, dlu_vk_frame_create(3) sets the lag to its frames in flight + 1
+*/
+#define DLU_VK_EVICT_FRAME_LAG 3
+
+VkResult dlu_vk_mem_get_budget(vkcomp *app, uint32_t cur_ld, uint32_t heap, VkDeviceSize *usage, VkDeviceSize *budget);
+
+/* Never let a heap's budget exceed budget bytes, 0 goes back to the driver's or DLU_VK_MEM_BUDGET_PERCENT */
+void dlu_vk_mem_set_budget(vkcomp *app, uint32_t cur_ld, VkDeviceSize budget);
+
+/* Replace the eviction policy, NULL restores dlu_vk_evict_lru_texture(3) */
+void dlu_vk_mem_set_evict_hook(vkcomp *app, uint32_t cur_ld, dlu_vk_evict_hook evict, void *data);
+
+/**
+* LRU bookkeeping: call dlu_vk_mem_next_frame(3) once per device frame (the frame engine does)
+* and dlu_vk_touch_texture(3) for every texture a frame samples. A texture is only ever
+* evicted once it was touched, or marked with dlu_vk_texture_set_evictable(3), after its
+* last creation. Textures the app doesn't track are left alone.
+*/
+void dlu_vk_mem_next_frame(vkcomp *app, uint32_t cur_ld);
+void dlu_vk_touch_texture(vkcomp *app, uint32_t cur_tex);
+void dlu_vk_texture_set_evictable(vkcomp *app, uint32_t cur_tex, bool evictable);
+
+/**
+* Default eviction policy. Frees the image, view and memory of the least recently used
+* evictable texture in the heap, keeping its sampler. Only textures whose memory makes room
+* are considered: a dedicated allocation, the last range handed out of a pool block, or a
+* range of at least size bytes in a block of type_idx and linear. Evicting anything else
+* would free no memory the allocation can use.
+*
+* Check dlu_vk_texture_evicted(3) before using a texture, an evicted one must be recreated
+* and uploaded again. Recreating it with dlu_create_texture_image(3) clears the flag.
+* Descriptor sets still point at the destroyed view, the caller must rewrite them before
+* binding them again. Bindless slots of the texture are pointed at the table's fallback
+* texture, or given back without one (see dlu_vk_bindless_set_fallback(3))
+*/
+bool dlu_vk_evict_lru_texture(vkcomp *app, uint32_t cur_ld, uint32_t heap, uint32_t type_idx, bool linear, VkDeviceSize size, void *data);
+bool dlu_vk_texture_evicted(vkcomp *app, uint32_t cur_tex);
+
+#ifdef INAPI_CALLS
+/**
+* Flush (or invalidate) offset..offset+size of a range, offset is relative to the range.
+* Rounded out to nonCoherentAtomSize, a no-op when the memory is host coherent
+*/
+VkResult dlu_vk_mem_sync(VkDevice device, VkDeviceMemory mem, dlu_vk_suballoc *sub, VkDeviceSize offset, VkDeviceSize size, bool flush);
+
+/* Whether a VkDeviceMemory object is a pool block */
+bool dlu_vk_mem_is_pooled(vkcomp *app, uint32_t cur_ld, VkDeviceMemory mem);
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_PROFILE_H
+#define DLU_VKCOMP_PROFILE_H
+
+/**
+* [GPU Profiler] Times command ranges on the graphics queue with timestamp queries.
+* Scopes are named, every scope with the same name in a frame adds up to one sample.
+* Each frame writes its timestamps into its own slice of a VkQueryPool, the slice is read
+* back when it comes around again frame_lag frames later. Results not ready by then are
+* dropped rather than waited on. With the frame engine frame_lag should be at least the
+* amount of frames in flight. Queries are baked into the command buffers they are
+* written to, so scopes don't work in buffers replayed by dlu_exec_record_cached(3)
+*/
+VkResult dlu_vk_profiler_create(vkcomp *app, uint32_t cur_ld, uint32_t max_scopes, uint32_t max_queries, uint32_t frame_lag);
+
+/**
+* Start a profiled frame, folds the timings of the frame that used the slice
+* frame_lag frames ago into the statistics and resets the slice's queries in cmd_buff.
+* Must be recorded outside a render pass, before any scope of the frame
+*/
+void dlu_vk_profiler_frame(vkcomp *app, uint32_t cur_ld, VkCommandBuffer cmd_buff);
+
+/**
+* Write the timestamp starting scope name, inside or outside a render pass. i.e with
+* dlu_exec_begin_render_pass(3) pass app->cmd_data[cur_pool].cmd_buffs[cur_buff].
+* Returns the query to pass dlu_vk_profiler_end(3), UINT32_MAX once the frame ran out of
+* queries or the profiler of names. name is copied
+*/
+uint32_t dlu_vk_profiler_begin(vkcomp *app, uint32_t cur_ld, VkCommandBuffer cmd_buff, const char *name);
+
+/* Write the timestamp ending a scope, cmd_buff must be submitted after the begin's */
+void dlu_vk_profiler_end(vkcomp *app, uint32_t cur_ld, VkCommandBuffer cmd_buff, uint32_t query);
+
+/* Rolling statistics of a scope, false if no frame recorded it yet */
+bool dlu_vk_profiler_get_stats(vkcomp *app, uint32_t cur_ld, const char *name, dlu_vk_profile_stats *stats);
+
+/* Print the statistics of every scope */
+void dlu_vk_profiler_print_stats(vkcomp *app, uint32_t cur_ld);
+
+#ifdef INAPI_CALLS
+/* Destroys the query pool and frees the profiler */
+void dlu_vk_profiler_destroy(vkcomp *app, uint32_t cur_ld);
+#endif
+
+#endif
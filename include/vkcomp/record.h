@@ -0,0 +1,63 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_RECORD_H
+#define DLU_VKCOMP_RECORD_H
+
+/**
+* [Parallel Recording] Gives cmd_data[cur_pool] thread_cnt recording threads, the calling
+* thread being one of them. Every thread owns a VkCommandPool per frame in flight
+* (frame_cnt of them), so no pool is ever shared between threads and a frame's pools are
+* reset as a whole once the GPU is done with it. queueFamilyIndex must match cur_pool's.
+* Worker threads are started once here and sleep between dlu_vk_record_parallel(3) calls
+*/
+VkResult dlu_vk_recorder_create(vkcomp *app, uint32_t cur_pool, uint32_t queueFamilyIndex, uint32_t thread_cnt, uint32_t frame_cnt);
+
+/**
+* Split draw_cnt draws into up to thread_cnt contiguous partitions, record each one into a
+* secondary command buffer in parallel then stitch them into cmd_data[cur_pool].cmd_buffs[cur_buff]
+* with vkCmdExecuteCommands(). The primary must be inside a render pass begun with
+* VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, inherit describes it, see
+* dlu_set_cmd_buff_inheritance_info(3). Secondaries inherit no state, record must bind its
+* pipeline, descriptor sets, vertex buffers and dynamic state. record is called concurrently.
+* The GPU must be done with frame's previous submission, with the frame engine pass the
+* cur_buff returned by dlu_vk_frame_begin(3) as frame. Returns once every partition is stitched
+*/
+VkResult dlu_vk_record_parallel(
+  vkcomp *app,
+  uint32_t cur_pool,
+  uint32_t cur_buff,
+  uint32_t frame,
+  const VkCommandBufferInheritanceInfo *inherit,
+  uint32_t draw_cnt,
+  dlu_vk_record_fn record,
+  void *data
+);
+
+#ifdef INAPI_CALLS
+/* Joins the worker threads and destroys every per thread command pool */
+void dlu_vk_recorder_destroy(vkcomp *app, uint32_t cur_pool);
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_RING_H
+#define DLU_VKCOMP_RING_H
+
+/**
+* [Uniform Streaming Ring] A host visible uniform buffer split into one slice per frame in flight.
+* Every object's uniforms for a frame are sub-allocated from that frame's slice and bound with a
+* VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptor plus the dynamic offset handed back, see
+* dlu_bind_desc_sets(3). The CPU writes frame N+1's slice while the GPU still reads frame N's,
+* one descriptor set serves every object.
+*/
+
+/**
+* Create the ring's VkBuffer at cur_bd. frame_size is rounded up to minUniformBufferOffsetAlignment.
+* The descriptor's VkDescriptorBufferInfo should use offset 0 and the size of one object as range
+*/
+VkResult dlu_create_uniform_ring(vkcomp *app, uint32_t cur_ld, uint32_t cur_bd, uint32_t frame_cnt, VkDeviceSize frame_size);
+
+/**
+* Start writing frame's slice. Only call once the GPU is done with the frame
+* that last used the slice, usually after waiting on that frame's render fence.
+* Fails if frame isn't less than the frame_cnt the ring was created with
+*/
+VkResult dlu_uniform_ring_begin(vkcomp *app, uint32_t cur_bd, uint32_t frame);
+
+/**
+* Sub-allocate size bytes from the current frame's slice. Returns where to write them,
+* NULL if the slice is full. dyn_offset is the offset to pass to dlu_bind_desc_sets(3)
+*/
+void *dlu_uniform_ring_alloc(vkcomp *app, uint32_t cur_bd, VkDeviceSize size, uint32_t *dyn_offset);
+
+/* Sub-allocate and copy data into the current frame's slice */
+VkResult dlu_uniform_ring_push(vkcomp *app, uint32_t cur_bd, VkDeviceSize size, const void *data, uint32_t *dyn_offset);
+
+/* Flush what was written to the current frame's slice, a no-op on host coherent memory */
+VkResult dlu_uniform_ring_end(vkcomp *app, uint32_t cur_bd);
+
+#endif
@@ -28,7 +28,7 @@
 /* Initailize vulkan struct */
 vkcomp *dlu_init_vk();
 
-/* Free up all swapchain related memory, must reinitialize these objects */
+/* Free up all swapchain related memory (depth and multisampled color targets included), must reinitialize these objects */
 void dlu_freeup_sc(vkcomp *app);
 
 /* Free up all allocated vkcomp related memory */
@@ -0,0 +1,72 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_TIMELINE_H
+#define DLU_VKCOMP_TIMELINE_H
+
+/**
+* [Timelines] One VK_KHR_timeline_semaphore per queue of a logical device. Every
+* dlu_vk_timeline_submit(3) signals the next point of its queue's timeline, so points only
+* ever increase. Work on one queue waits on points of other queues on the GPU and the host
+* waits on any set of points, no fence per submission and no CPU stall between queues.
+* Swap chain acquire and present still need the binary semaphores of dlu_create_syncs(3).
+* The extension must be passed to dlu_create_logical_device(3) and the queues retrieved
+* with dlu_create_device_queue(3) beforehand
+*/
+VkResult dlu_vk_timeline_create(vkcomp *app, uint32_t cur_ld);
+
+/**
+* Submit commands to a queue once every point in pWaits is reached, pWaitStages holds the
+* stage each wait blocks. point is set to the queue's point signaled when the commands complete
+*/
+VkResult dlu_vk_timeline_submit(
+  vkcomp *app,
+  uint32_t cur_ld,
+  dlu_queue_type queue,
+  uint32_t commandBufferCount,
+  const VkCommandBuffer *pCommandBuffers,
+  uint32_t waitCount,
+  const dlu_vk_timeline_point *pWaits,
+  const VkPipelineStageFlags *pWaitStages,
+  uint64_t *point
+);
+
+/* Latest point of a queue's timeline the GPU reached, never blocks. 0 on failure */
+uint64_t dlu_vk_timeline_completed(vkcomp *app, uint32_t cur_ld, dlu_queue_type queue);
+
+/* Latest point handed out for a queue, waiting on it waits on everything submitted to the queue */
+uint64_t dlu_vk_timeline_last(vkcomp *app, uint32_t cur_ld, dlu_queue_type queue);
+
+/**
+* Host wait until every point in pPoints is reached or timeout nanoseconds pass.
+* Returns VK_TIMEOUT in the latter case
+*/
+VkResult dlu_vk_timeline_wait(vkcomp *app, uint32_t cur_ld, uint32_t pointCount, const dlu_vk_timeline_point *pPoints, uint64_t timeout);
+
+#ifdef INAPI_CALLS
+/* Waits on the last point of every queue then destroys the timelines */
+void dlu_vk_timeline_destroy(vkcomp *app, uint32_t cur_ld);
+#endif
+
+#endif
@@ -65,11 +65,143 @@ typedef enum _dlu_destroy_type {
   DLU_DESTROY_VK_LOGIC_DEVICE = 0x0011 /* Destroy VkDevice Objects */
 } dlu_destroy_type;
 
+typedef enum _dlu_queue_type {
+  DLU_VK_GRAPHICS_QUEUE = 0x0000,
+  DLU_VK_TRANSFER_QUEUE = 0x0001,
+  DLU_VK_COMPUTE_QUEUE = 0x0002,
+  DLU_VK_QUEUE_CNT = 0x0003
+} dlu_queue_type;
+
 typedef enum _dlu_mem_map_type {
   DLU_VK_BUFFER = 0x0000,
   DLU_TEXT_VK_IMAGE = 0x0001
 } dlu_mem_map_type;
 
+/* Single time submissions that can be in flight at once per command pool */
+#define DLU_EXEC_BATCH_CNT 4
+
+/* Opaque VkDeviceMemory block of the device memory pool, see vkcomp/mem.h */
+typedef struct _dlu_vk_mem_block dlu_vk_mem_block;
+
+/* Opaque transfer queue upload engine, see vkcomp/upload.h */
+typedef struct _dlu_vk_uploader dlu_vk_uploader;
+
+/* Opaque bindless texture table, see vkcomp/bindless.h */
+typedef struct _dlu_vk_bindless dlu_vk_bindless;
+
+/* Opaque frames in flight engine, see vkcomp/frame.h */
+typedef struct _dlu_vk_frames dlu_vk_frames;
+
+/* Opaque parallel command recorder, see vkcomp/record.h */
+typedef struct _dlu_vk_recorder dlu_vk_recorder;
+
+/* Opaque per queue timeline semaphores, see vkcomp/timeline.h */
+typedef struct _dlu_vk_timelines dlu_vk_timelines;
+
+/* Opaque GPU timestamp profiler, see vkcomp/profile.h */
+typedef struct _dlu_vk_profiler dlu_vk_profiler;
+
+/* Point value of a queue's timeline, see dlu_vk_timeline_submit(3) */
+typedef struct _dlu_vk_timeline_point {
+  dlu_queue_type queue;
+  uint64_t value;
+} dlu_vk_timeline_point;
+
+/**
+* Range of a VkDeviceMemory block sub-allocated by the device memory pool, see dlu_vk_mem_alloc(3)
+* offset | Offset of the range in the VkDeviceMemory object
+* size   | Size of the range, a power of two
+* block  | Pool block the range belongs to, NULL if the VkDeviceMemory object is dedicated
+* map    | Persistent host address of the range, NULL if the memory isn't host visible
+* atom   | nonCoherentAtomSize if the memory is host visible but not host coherent, 0 otherwise
+* heap   | Memory heap the VkDeviceMemory object was allocated from
+*/
+typedef struct _dlu_vk_suballoc {
+  VkDeviceSize offset;
+  VkDeviceSize size;
+  dlu_vk_mem_block *block;
+  void *map;
+  VkDeviceSize atom;
+  uint32_t heap;
+} dlu_vk_suballoc;
+
+/* Amount of VkSystemAllocationScope values, command through instance */
+#define DLU_VK_ALLOC_SCOPE_CNT 5
+
+/**
+* Driver host allocations of one scope, see dlu_vk_host_alloc_get_stats(3)
+* used      | Bytes the driver holds through the allocation callbacks
+* peak      | Highest value of used
+* internal  | Bytes the driver reported allocating on its own (pfnInternalAllocation)
+* alloc_cnt | Amount of allocations, reallocations included
+* free_cnt  | Amount of allocations released
+* arena_cnt | Allocations served from the dedicated arena
+* fail_cnt  | Allocations refused because of the limit or lack of memory
+*/
+typedef struct _dlu_vk_host_alloc_stats {
+  size_t used;
+  size_t peak;
+  size_t internal;
+  uint64_t alloc_cnt;
+  uint64_t free_cnt;
+  uint64_t arena_cnt;
+  uint64_t fail_cnt;
+} dlu_vk_host_alloc_stats;
+
+/* Frames the profiler's rolling statistics cover */
+#define DLU_VK_PROFILE_WINDOW 64
+
+/**
+* GPU time of a profiler scope in milliseconds, see dlu_vk_profiler_get_stats(3)
+* last    | Latest frame read back
+* avg     | Average of the last samples frames, at most DLU_VK_PROFILE_WINDOW
+* min/max | Extremes of those frames
+* dropped | Frames whose timestamps weren't available in time
+*/
+typedef struct _dlu_vk_profile_stats {
+  double last;
+  double avg;
+  double min;
+  double max;
+  uint32_t samples;
+  uint64_t dropped;
+} dlu_vk_profile_stats;
+
+/**
+* Per draw push constant block of bindless rendering, see dlu_vk_bindless_push(3)
+* vertices | buff_data[].addr (plus offset) of the draw's vertex data, read in the vertex shader
+* texture  | Slot of the draw's texture in the bindless table
+* instance | Free for the application, keeps the block 16 bytes
+*/
+typedef struct _dlu_vk_bindless_draw {
+  VkDeviceAddress vertices;
+  uint32_t texture;
+  uint32_t instance;
+} dlu_vk_bindless_draw;
+
+struct _vkcomp;
+
+/**
+* Called when allocating size bytes from heap would exceed its budget, see dlu_vk_mem_set_evict_hook(3).
+* type_idx and linear describe the pool blocks a range of size bytes is wanted from, freeing a range
+* of any other block only helps if it empties the block. type_idx is UINT32_MAX when the allocation
+* needs a VkDeviceMemory object of its own. Should free something from that heap and return true,
+* false once there's nothing left to free
+*/
+typedef bool (*dlu_vk_evict_hook)(struct _vkcomp *app, uint32_t cur_ld, uint32_t heap, uint32_t type_idx, bool linear, VkDeviceSize size, void *data);
+
+/**
+* Records draws [first, first + count) into the secondary cmd_buff from recording thread thread,
+* see dlu_vk_record_parallel(3). Called concurrently, once per partition
+*/
+typedef void (*dlu_vk_record_fn)(struct _vkcomp *app, VkCommandBuffer cmd_buff, uint32_t thread, uint32_t first, uint32_t count, void *data);
+
+/**
+* Records the render pass contents of cmd_data[cur_pool].cmd_buffs[cur_buff], see dlu_exec_record_cached(3).
+* Only called when the command buffer is dirty
+*/
+typedef void (*dlu_exec_record_fn)(struct _vkcomp *app, uint32_t cur_pool, uint32_t cur_buff, void *data);
+
 typedef struct _vkcomp {
   /* Function pointers bellow are used for debugging purposes */ 
   PFN_vkQueueBeginDebugUtilsLabelEXT dbg_utils_queue_begin;
@@ -81,8 +213,18 @@ typedef struct _vkcomp {
   PFN_vkSetDebugUtilsObjectNameEXT dbg_utils_set_object_name;
 
   PFN_vkDestroyDebugUtilsMessengerEXT dbg_destroy_utils_msg;
+
+  /* Retrieved when a logical device enables VK_EXT_memory_budget */
+  PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_mem_props2;
+
+  /* Retrieved when a logical device enables an extension whose features must be queried first */
+  PFN_vkGetPhysicalDeviceFeatures2 get_feats2;
+  PFN_vkGetPhysicalDeviceProperties2 get_props2;
   VkDebugUtilsMessengerEXT debug_utils_msg;
 
+  /* Passed to every vkCreate and vkDestroy call, NULL unless dlu_vk_host_alloc_create(3) was called */
+  VkAllocationCallbacks *vk_alloc;
+
   VkInstance instance;
   VkSurfaceKHR surface;
 
@@ -101,6 +243,57 @@ typedef struct _vkcomp {
     VkQueue compute;
     VkDevice device;
     uint32_t pdi; /* Physical device data index */
+
+    /* Device memory pool blocks, VkDeviceMemory objects resources are sub-allocated from */
+    dlu_vk_mem_block *mem_blocks;
+
+    /* Streams data to resources on the transfer queue, see dlu_vk_upload_create(3) */
+    dlu_vk_uploader *upload;
+
+    /**
+    * Bindless rendering, see dlu_vk_bindless_create(3)
+    * bda           | VK_KHR_buffer_device_address was enabled, device memory is allocated with
+    *                 VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+    * get_buff_addr | Retrieved when bda is set
+    * bindless      | Descriptor indexed texture table
+    */
+    bool bda;
+    PFN_vkGetBufferDeviceAddressKHR get_buff_addr;
+    dlu_vk_bindless *bindless;
+
+    /**
+    * Timeline semaphores, see dlu_vk_timeline_create(3)
+    * timeline  | VK_KHR_timeline_semaphore was enabled, the functions bellow are retrieved
+    * timelines | A timeline per queue
+    */
+    bool timeline;
+    PFN_vkWaitSemaphoresKHR wait_sems;
+    PFN_vkGetSemaphoreCounterValueKHR get_sem_value;
+    dlu_vk_timelines *timelines;
+
+    /* GPU timestamp profiler, see dlu_vk_profiler_create(3) */
+    dlu_vk_profiler *profiler;
+
+    /**
+    * Device memory budget, see dlu_vk_mem_get_budget(3)
+    * budget_ext | VK_EXT_memory_budget was enabled on the device
+    * heap_usage | Bytes of VkDeviceMemory vkcomp allocated from each heap
+    * budget_cap | Upper bound of every heap's budget, 0 if there's none, see dlu_vk_mem_set_budget(3)
+    * frame      | Frame counter textures are stamped with for LRU eviction
+    * engines    | Swap chains with a frame engine, frame advances once each of them ended a frame
+    * ended      | Frame engines that ended a frame since frame last advanced
+    * evict_lag  | Frames a texture must go unused before eviction, 0 uses DLU_VK_EVICT_FRAME_LAG
+    * evict      | Eviction policy, NULL evicts the least recently used textures
+    */
+    bool budget_ext;
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize budget_cap;
+    uint64_t frame;
+    uint32_t engines;
+    uint32_t ended;
+    uint32_t evict_lag;
+    dlu_vk_evict_hook evict;
+    void *evict_data;
   } *ld_data;
 
   uint32_t sdc; /* swap chain data count */
@@ -131,12 +324,18 @@ typedef struct _vkcomp {
       } sem;
     } *syncs;
 
-    /* Generally only need one depth buffer for multiple swap chain images */
-    struct _depth_buffer {
+    dlu_vk_frames *frames; /* NULL until dlu_vk_frame_create() */
+
+    /**
+    * Generally only need one depth buffer for multiple swap chain images
+    * msaa: Multisampled color target, resolved into the swap chain image at the end of the render pass
+    */
+    struct _sc_attachment {
       VkImage image;
       VkImageView view;
       VkDeviceMemory mem;
-    } depth;
+      dlu_vk_suballoc sub;
+    } depth, msaa;
 
     /* logical device index, Used to keep track of active VkDevice */
     uint32_t ldi;
@@ -163,8 +362,32 @@ typedef struct _vkcomp {
   uint32_t cdc; /* command data count */
   struct _cmd_data {
     VkCommandPool cmd_pool;
+    VkCommandPoolCreateFlags flags; /* cmd_pool's create flags */
     VkCommandBuffer *cmd_buffs;
 
+    /**
+    * Batched single time submissions, see dlu_exec_begin_batch(3). Batch tickets start at 1,
+    * ticket t lives in batches[(t - 1) % DLU_EXEC_BATCH_CNT]
+    * submitted | Amount of batches submitted, the batch being recorded has ticket submitted + 1
+    */
+    uint64_t submitted;
+    struct _cmd_batch {
+      VkCommandBuffer cmd_buff;
+      VkFence fence;
+      uint64_t ticket; /* 0 if the slot was never used */
+      bool recording;
+    } batches[DLU_EXEC_BATCH_CNT];
+
+    dlu_vk_recorder *recorder; /* NULL until dlu_vk_recorder_create() */
+
+    /**
+    * Record once command buffers, see dlu_exec_record_cached(3)
+    * state    | Bumped by dlu_exec_mark_dirty(3)
+    * recorded | state + 1 when cmd_buffs[i] was last recorded, 0 if never or the swap chain changed
+    */
+    uint64_t state;
+    uint64_t *recorded;
+
     /* logical device index, Used to keep track of active VkDevice */
     uint32_t ldi;
   } *cmd_data;
@@ -173,6 +396,26 @@ typedef struct _vkcomp {
   struct _buff_data {
     VkBuffer buff;
     VkDeviceMemory mem;
+    dlu_vk_suballoc sub; /* Range of mem the buffer is bound to */
+
+    /* Shaders reach the buffer through this address, 0 without VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT */
+    VkDeviceAddress addr;
+
+    /**
+    * Uniform streaming ring, see dlu_create_uniform_ring(3). Each frame in flight owns a slice
+    * align      | minUniformBufferOffsetAlignment, every dynamic offset handed out is a multiple of it
+    * frame_size | Bytes in each frame's slice, zero if the buffer isn't a ring
+    * frame_cnt  | Amount of slices, zero if the buffer isn't a ring
+    * frame      | Frame whose slice is currently being written
+    * head       | Bytes of the current slice handed out
+    */
+    struct _uniform_ring {
+      VkDeviceSize align;
+      VkDeviceSize frame_size;
+      uint32_t frame_cnt;
+      uint32_t frame;
+      VkDeviceSize head;
+    } ring;
 
     /* logical device index, Used to keep track of active VkDevice */
     uint32_t ldi;
@@ -194,7 +437,11 @@ typedef struct _vkcomp {
     VkImage image;
     VkImageView view;
     VkDeviceMemory mem;
+    dlu_vk_suballoc sub; /* Range of mem the image is bound to */
     VkSampler sampler;
+    uint64_t last_use; /* Logical device frame the texture was last used in, see dlu_vk_touch_texture(3) */
+    bool evictable; /* Touched or marked evictable since it was created, only these are evicted */
+    bool evicted; /* Evicted since it was last created, see dlu_vk_texture_evicted(3) */
 
     /* logical device index, Used to keep track of active VkDevice */
     uint32_t ldi;
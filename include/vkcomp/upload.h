@@ -0,0 +1,98 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#ifndef DLU_VKCOMP_UPLOAD_H
+#define DLU_VKCOMP_UPLOAD_H
+
+/**
+* [Upload Engine] Streams buffer and texture data to the device on the dedicated transfer queue.
+* Data is copied into a pool of persistently mapped staging buffers, one per batch, and the copies
+* are recorded into transfer queue command buffers. Resources are released from the transfer
+* queue family and acquired by the graphics queue family. Each batch gets a ticket, its fence
+* tells when the uploads are usable. Rendering never waits on vkQueueWaitIdle for an upload.
+* If the device has no separate transfer family everything is submitted on the graphics queue.
+* Destination resources must be created with VK_SHARING_MODE_EXCLUSIVE.
+*/
+#define DLU_VK_UPLOAD_BATCH_CNT 4
+
+/**
+* Create the upload engine of a logical device. staging_size is the size of each batch's
+* staging buffer, larger uploads get a batch with a staging buffer of their own size.
+* The logical device's transfer queue is used if dlu_create_device_queue(3) retrieved one
+*/
+VkResult dlu_vk_upload_create(vkcomp *app, uint32_t cur_ld, VkDeviceSize staging_size);
+
+/* Waits on every batch in flight then frees the upload engine */
+void dlu_vk_upload_destroy(vkcomp *app, uint32_t cur_ld);
+
+/**
+* Record a copy of size bytes of data into cur_bd at offset. dst_stage and dst_access
+* describe how the graphics queue uses the buffer afterwards. ticket is set to the batch
+* the upload belongs to. Nothing is submitted until dlu_vk_upload_submit(3)
+*/
+VkResult dlu_vk_upload_buffer(
+  vkcomp *app,
+  uint32_t cur_ld,
+  uint32_t cur_bd,
+  VkDeviceSize offset,
+  VkDeviceSize size,
+  const void *data,
+  VkPipelineStageFlags dst_stage,
+  VkAccessFlags dst_access,
+  uint64_t *ticket
+);
+
+/**
+* Record a copy of tightly packed texel data into the whole extent of cur_tex's image.
+* The image goes from VK_IMAGE_LAYOUT_UNDEFINED to final_layout (usually
+* VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL), ready for dst_stage/dst_access on the graphics queue
+*/
+VkResult dlu_vk_upload_image(
+  vkcomp *app,
+  uint32_t cur_ld,
+  uint32_t cur_tex,
+  VkDeviceSize size,
+  const void *data,
+  VkExtent3D extent,
+  VkImageSubresourceRange sub_rr,
+  VkImageLayout final_layout,
+  VkPipelineStageFlags dst_stage,
+  VkAccessFlags dst_access,
+  uint64_t *ticket
+);
+
+/**
+* Submit the batch being recorded. ticket (if not NULL) is set to the submitted batch's ticket.
+* On failure the batch's uploads are lost and must be recorded again, whatever part of it
+* reached the device is finished before its staging buffer is reused
+*/
+VkResult dlu_vk_upload_submit(vkcomp *app, uint32_t cur_ld, uint64_t *ticket);
+
+/* Whether a batch finished and its resources can be used, never blocks */
+bool dlu_vk_upload_done(vkcomp *app, uint32_t cur_ld, uint64_t ticket);
+
+/* Block until a batch finishes, submitting it first if it's still being recorded */
+VkResult dlu_vk_upload_wait(vkcomp *app, uint32_t cur_ld, uint64_t ticket);
+
+#endif
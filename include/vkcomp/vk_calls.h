@@ -31,6 +31,24 @@ VkResult dlu_vk_sync(dlu_sync_type type, vkcomp *app, uint32_t cur_scd, uint32_t
 /* Allows for more developer vulkan object destruction control */
 void dlu_vk_destroy(dlu_destroy_type type, vkcomp *app, uint32_t cur_ld, void *data);
 
+/**
+* Host visible buffers and images stay mapped for their whole lifetime.
+* Returns a stable pointer offset bytes into the resource that can be written
+* to directly, NULL if the resource's memory isn't host visible.
+*/
+void *dlu_vk_get_mapped(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset);
+
+/**
+* Memory that's host visible but not host coherent (usually host cached) must be
+* flushed after the host writes to it and invalidated before the host reads what
+* the device wrote. Only the given range is flushed or invalidated, rounded out to
+* nonCoherentAtomSize. Pass VK_WHOLE_SIZE as size to cover the rest of the resource.
+* Both are no-ops on host coherent memory.
+*/
+VkResult dlu_vk_flush_mem(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset, VkDeviceSize size);
+VkResult dlu_vk_invalidate_mem(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset, VkDeviceSize size);
+
+/* Copy size bytes of data into the resource's persistently mapped memory at offset, then flush them */
 VkResult dlu_vk_map_mem(
   dlu_mem_map_type type,
   vkcomp *app,
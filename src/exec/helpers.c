@@ -61,6 +61,7 @@ void help_message() {
   dlu_print_msg(DLU_INFO, "\t-i, --pie\t\t\t Print instance extenstion list\n");
   dlu_print_msg(DLU_INFO, "\t-d, --pde=<VkPhysicalDeviceType> Print device extenstion list\n");
   dlu_print_msg(DLU_INFO, "\t    --display-info=<drm device>  Display compatible DRM Device and it's capabilities\n");
+  dlu_print_msg(DLU_INFO, "\t    --mem-stats\t\t\t Print memory block usage of the Vulkan options that follow\n");
   dlu_print_msg(DLU_INFO, "\t-v, --version\t\t\t Print lucurious library version\n");
   dlu_print_msg(DLU_INFO, "\t-h, --help\t\t\t Show this message\n");
 }
@@ -39,6 +39,14 @@ void print_validation_layers();
 void print_instance_extensions();
 void print_device_extensions(VkPhysicalDeviceType dt);
 
+static bool mem_stats = false;
+
+/* Options release their blocks once done, --mem-stats reports how much of them was used first */
+void release_blocks() {
+  if (mem_stats) dlu_print_mem_stats(DLU_LARGE_BLOCK_PRIV);
+  dlu_release_blocks();
+}
+
 int main(int argc, char **argv) {
   int c = 0;
   int8_t track = 0;
@@ -53,6 +61,7 @@ int main(int argc, char **argv) {
       {"pie",          no_argument,       NULL,  0  },
       {"pde",          required_argument, NULL,  0  },
       {"display-info", optional_argument, NULL,  0  },
+      {"mem-stats",    no_argument,       NULL,  0  },
       {0,              0,                 NULL,  0  }
     };
 
@@ -67,6 +76,8 @@ int main(int argc, char **argv) {
         if (!strcmp(long_options[option_index].name, "pgvl")) print_validation_layers();
         if (!strcmp(long_options[option_index].name, "pie")) print_instance_extensions();
         if (!strcmp(long_options[option_index].name, "display-info")) dlu_print_dconf_info(optarg);
+        /* Report memory block usage of the options that follow */
+        if (!strcmp(long_options[option_index].name, "mem-stats")) mem_stats = true;
         if (!strcmp(long_options[option_index].name, "pde")) {
           if (optarg) {
             print_device_extensions(ret_dtype(optarg));
@@ -28,6 +28,9 @@
 /* In helpers.c */
 void lower_to_upper(char *s);
 
+/* In main.c */
+void release_blocks();
+
 void print_validation_layers() {
   dlu_otma_mems ma = {.vkcomp_cnt = 1, .vk_layer_cnt = 10 };
   if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) return;
@@ -58,7 +61,7 @@ void print_validation_layers() {
 end_free_vk:
   dlu_freeup_vk(app);
 end:
-  dlu_release_blocks();
+  release_blocks();
 }
 
 void print_instance_extensions() {
@@ -92,7 +95,7 @@ void print_instance_extensions() {
 end_free_vk:
   dlu_freeup_vk(app);
 end:
-  dlu_release_blocks();
+  release_blocks();
 }
 
 void print_device_extensions(VkPhysicalDeviceType dt) {
@@ -166,5 +169,5 @@ end_free_lprops:
 end_free_vk:
   dlu_freeup_vk(app);
 end:
-  dlu_release_blocks();
+  release_blocks();
 }
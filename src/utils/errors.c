@@ -193,6 +193,34 @@ void _show_err_msg(uint32_t dlu_err, int vkerr, const char *dlu_msg) {
       dlu_log_me(DLU_DANGER, "[x] Must have a VkDevice or a VkPhysicalDevice association");
       dlu_log_me(DLU_DANGER, "[x] Must make a call to %s to create that association", dlu_msg);
       break;
+    case DLU_VKCOMP_MEM_NOT_MAPPED:
+      dlu_log_me(DLU_DANGER, "[x] VkDeviceMemory is not host visible, it can't be written to directly");
+      dlu_log_me(DLU_DANGER, "[x] Must allocate it with VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT");
+      break;
+    case DLU_VKCOMP_UPLOAD:
+      dlu_log_me(DLU_DANGER, "[x] The logical device has no upload engine");
+      dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_vk_upload_create()");
+      break;
+    case DLU_VKCOMP_BINDLESS:
+      dlu_log_me(DLU_DANGER, "[x] The logical device has no bindless texture table");
+      dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_vk_bindless_create()");
+      break;
+    case DLU_VKCOMP_FRAMES:
+      dlu_log_me(DLU_DANGER, "[x] The swap chain has no frame engine or no frame is being recorded");
+      dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_vk_frame_create() then dlu_vk_frame_begin()");
+      break;
+    case DLU_VKCOMP_RECORDER:
+      dlu_log_me(DLU_DANGER, "[x] The command pool has no parallel recorder");
+      dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_vk_recorder_create()");
+      break;
+    case DLU_VKCOMP_TIMELINE:
+      dlu_log_me(DLU_DANGER, "[x] The logical device has no timelines");
+      dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_vk_timeline_create()");
+      break;
+    case DLU_VKCOMP_PROFILER:
+      dlu_log_me(DLU_DANGER, "[x] The logical device has no profiler or no profiled frame was started");
+      dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_vk_profiler_create() then dlu_vk_profiler_frame()");
+      break;
     case DLU_BUFF_NOT_ALLOC:
       dlu_log_me(DLU_DANGER, "[x] Must make a call to dlu_otba(): %s", dlu_msg);
       break;
@@ -0,0 +1,99 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#include <sys/mman.h>
+
+#include <lucom.h>
+
+#define FRAME_ALIGN 16
+
+/**
+* Frame arena state is stored at the start of its own mapping
+* frame_cnt | Amount of regions, one per frame in flight
+* size      | Bytes in each region
+* map_size  | Bytes mapped, including this struct
+* regions   | Start of the first region
+* offsets   | Bytes used in each region
+*/
+struct _dlu_frame_arena {
+  uint32_t frame_cnt;
+  size_t size;
+  size_t map_size;
+  void *regions;
+  size_t offsets[];
+};
+
+static size_t frame_round(size_t bytes) {
+  return (bytes + FRAME_ALIGN - 1) & ~((size_t) FRAME_ALIGN - 1);
+}
+
+dlu_frame_arena *dlu_frame_arena_create(uint32_t frame_cnt, size_t bytes) {
+  dlu_frame_arena *fa = NULL;
+  if (!frame_cnt) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  size_t head = frame_round(sizeof(dlu_frame_arena) + (frame_cnt * sizeof(size_t)));
+  if (bytes > SIZE_MAX - FRAME_ALIGN) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+  size_t size = frame_round(bytes);
+
+  /* Every frame's region must fit in the mapping's size */
+  if (size > (SIZE_MAX - head) / frame_cnt) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  fa = mmap(NULL, head + (frame_cnt * size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (fa == MAP_FAILED) { dlu_log_me(DLU_DANGER, "[x] mmap: %s", strerror(errno)); return NULL; }
+
+  fa->frame_cnt = frame_cnt;
+  fa->size = size;
+  fa->map_size = head + (frame_cnt * size);
+  fa->regions = ((void *) fa) + head;
+
+  return fa;
+}
+
+void *dlu_frame_alloc(dlu_frame_arena *fa, uint32_t frame, size_t bytes) {
+  if (!fa) return NULL;
+
+  frame %= fa->frame_cnt;
+
+  /* Rounding a request larger than a region could wrap around */
+  if (bytes > fa->size) return NULL;
+  bytes = frame_round(bytes);
+
+  if (bytes > (fa->size - fa->offsets[frame])) return NULL;
+
+  void *ptr = fa->regions + (frame * fa->size) + fa->offsets[frame];
+  fa->offsets[frame] += bytes;
+
+  return ptr;
+}
+
+void dlu_frame_reset(dlu_frame_arena *fa, uint32_t frame) {
+  if (!fa) return;
+  fa->offsets[frame % fa->frame_cnt] = 0;
+}
+
+void dlu_frame_arena_destroy(dlu_frame_arena *fa) {
+  if (!fa) return;
+  if (munmap(fa, fa->map_size) == NEG_ONE)
+    dlu_log_me(DLU_DANGER, "[x] munmap: %s", strerror(errno));
+}
@@ -22,10 +22,13 @@
 * THE SOFTWARE.
 */
 
+#define _GNU_SOURCE
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <pthread.h>
 
 #include <lucom.h>
 #include "../../include/vkcomp/types.h"
@@ -33,77 +36,306 @@
 
 #define BLOCK_SIZE sizeof(dlu_mem_block_t)
 
+/* Small block sizes are rounded to a multiple of BLOCK_ALIGN. Keeps every block 16 byte aligned */
+#define BLOCK_ALIGN 16
+
+/* Amount of segregated free lists (size classes). One bit per list in dlu_arena bin_map */
+#define BIN_CNT 64
+
+/* Size of the huge pages used by DLU_BLOCK_HUGE_PAGES */
+#define HUGE_PAGE_SIZE (1UL << 21)
+
 /**
 * Struct that stores block metadata
 * Using linked list to keep track of memory allocated
 * next     | points to next memory block
 * size     | allocated memory size
-* abytes   | available bytes left in block
-* addr     | Current address of the block
+* abytes   | available bytes left in block (for small blocks: 0 if in use, size if released)
+* arena    | Arena that handed the block out, NULL while it was never handed out
 * saddr    | Starting address of the block where data is assigned
-* prv_addr | Address of the previous block
+* prv_addr | Address of the previous block (for released small blocks: next block in its free list)
 */
 typedef struct mblock {
   struct mblock *next;
   size_t size;
   size_t abytes;
-  void *addr;
+  struct _dlu_arena *arena;
   void *saddr;
   void *prv_addr;
 } dlu_mem_block_t;
 
 /**
-* Globals used to keep track of memory blocks
-* sstart_addr_priv: Keep track of first allocated private small block address
-* large_block_priv: A struct to keep track of one large allocated private block
-* small_block_priv: A linked list for smaller allocated private block
-* sstart_addr_shared: Keep track of first allocated small shared block address
-* large_block_shared: A struct to keep track of one large allocated shared block
-* small_block_shared: linked list for smaller allocated shared blocks
+* Struct that stores the state of an arena
+* An arena is one large block with a linked list of smaller blocks sub-allocated from it
+* type        | Small block type the arena hands out (DLU_SMALL_BLOCK_PRIV/DLU_SMALL_BLOCK_SHARED)
+* flags       | dlu_block_flags the arena was created with
+* sstart_addr | Keep track of first allocated small block address
+* large_block | A struct to keep track of the large block the arena sub-allocates from
+*               In chained mode large blocks (chunks) are linked through their next member
+* chunk       | Large block small blocks are currently sub-allocated from (last chunk in the chain)
+* small_block | A linked list for smaller blocks (points to the last allocated one)
+* parent      | Arena the large block was carved from, NULL if the arena owns its mapping
+* bin_map     | Bit i is set when bins[i] isn't empty, gives O(1) lookup of a non-empty list
+* bins        | Segregated free lists of released small blocks, one per size class
+*               In header-less mode these are payload addresses linked through their first bytes,
+*               except in the exported block where the links are kept privately (see hl_link())
+* reserved    | Bytes mapped for every chunk, metadata included
+* consumed    | Bytes taken from chunks by small blocks (metadata included)
+* released    | Bytes sitting in the free lists
+* peak        | Highest consumed - released reached
+* alloc_cnt   | Amount of small block allocations
+* free_cnt    | Amount of small blocks released
+*/
+struct _dlu_arena {
+  dlu_block_type type;
+  uint32_t flags;
+  void *sstart_addr;
+  dlu_mem_block_t *large_block;
+  dlu_mem_block_t *chunk;
+  dlu_mem_block_t *small_block;
+  struct _dlu_arena *parent;
+  uint64_t bin_map;
+  dlu_mem_block_t *bins[BIN_CNT];
+  size_t reserved;
+  size_t consumed;
+  size_t released;
+  size_t peak;
+  uint64_t alloc_cnt;
+  uint64_t free_cnt;
+};
+
+static size_t bin_size(uint32_t bin);
+static uint32_t bin_ceil(size_t bytes);
+
+static size_t block_round(size_t bytes) {
+  if (!bytes) return BLOCK_ALIGN;
+  return (bytes + BLOCK_ALIGN - 1) & ~((size_t) BLOCK_ALIGN - 1);
+}
+
+/**
+* Round a request up to the smallest size of the class it's served from. Released blocks are
+* filed under bin_floor() of their size, so a block must be at least bin_size(bin_ceil()) to be
+* found again by a request of the same size. Anything passed the last class keeps its size.
+*/
+static size_t class_round(size_t bytes) {
+  size_t size = bin_size(bin_ceil(block_round(bytes)));
+  return (size < bytes) ? block_round(bytes) : size;
+}
+
+/**
+* Bytes a small block of a given size takes from the large block
+* Header-less blocks are rounded to their size class and use one side table byte per granule
+*/
+static size_t block_cost(uint32_t flags, size_t bytes) {
+  if (flags & DLU_BLOCK_HEADERLESS) {
+    bytes = class_round(bytes);
+    return bytes + (bytes / BLOCK_ALIGN);
+  }
+
+  return BLOCK_SIZE + class_round(bytes);
+}
+
+/**
+* Globals used to keep track of the process wide arenas created by dlu_otma(3)
+* These may be used by any thread so every access goes through their lock
+* priv_arena:   Arena for private blocks
+* shared_arena: Arena for shared blocks
+*/
+static dlu_arena priv_arena = { .type = DLU_SMALL_BLOCK_PRIV };
+static dlu_arena shared_arena = { .type = DLU_SMALL_BLOCK_SHARED };
+static pthread_mutex_t priv_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+* Bytes held by dlu_otba(3) arrays for each dlu_data_type, see otba_index()
+* otba_type is the type dlu_otba(3) is currently allocating for on this thread
+*/
+static size_t otba_bytes[DLU_OTBA_TYPE_CNT];
+static _Thread_local int otba_type = NEG_ONE;
+
+/* memfd backing the first shared large block, what dlu_export_shared_block(3) hands out */
+static int shared_fd = NEG_ONE;
+
+/**
+* Arena bound to the calling thread via dlu_arena_bind(3)
+* When set small block allocations of the same type are served from it without locking
+*/
+static _Thread_local dlu_arena *bound_arena = NULL;
+
+static dlu_arena *get_global_arena(dlu_block_type type, pthread_mutex_t **lock) {
+  switch (type) {
+    case DLU_LARGE_BLOCK_PRIV:
+    case DLU_SMALL_BLOCK_PRIV:
+      *lock = &priv_lock;
+      return &priv_arena;
+    case DLU_LARGE_BLOCK_SHARED:
+    case DLU_SMALL_BLOCK_SHARED:
+      *lock = &shared_lock;
+      return &shared_arena;
+    default: break;
+  }
+
+  return NULL;
+}
+
+/* Small blocks are served from the calling thread's arena when one of the same type is bound */
+static dlu_arena *get_arena(dlu_block_type type, pthread_mutex_t **lock) {
+  if (bound_arena && bound_arena->type == type) {
+    *lock = NULL;
+    return bound_arena;
+  }
+
+  return get_global_arena(type, lock);
+}
+
+/**
+* Size classes are 16 byte steps up to 128 bytes, then four classes per power of two
+* 16, 32, ..., 128, 160, 192, 224, 256, 320, ... up to 2MB. The last class also holds anything larger.
+* Returns the smallest size a block in the class can have
+*/
+static size_t bin_size(uint32_t bin) {
+  if (bin < 7) return (bin + 1) * BLOCK_ALIGN;
+  uint32_t k = (bin - 7) >> 2, j = (bin - 7) & 3;
+  return (128UL << k) + j * (32UL << k);
+}
+
+/* Class a released block of size bytes is filed under. Every block in it is at least bin_size() */
+static uint32_t bin_floor(size_t bytes) {
+  if (bytes < 128) return (bytes / BLOCK_ALIGN) - 1;
+
+  uint32_t k = (63 - __builtin_clzl(bytes)) - 7;
+  uint32_t bin = 7 + (k << 2) + ((bytes - (128UL << k)) / (32UL << k));
+  return (bin < BIN_CNT) ? bin : BIN_CNT - 1;
+}
+
+/* Class a request of size bytes is served from. Every block in it is large enough */
+static uint32_t bin_ceil(size_t bytes) {
+  uint32_t bin = bin_floor(bytes);
+  return (bin_size(bin) < bytes && bin < BIN_CNT - 1) ? bin + 1 : bin;
+}
+
+static void put_bin_block(dlu_arena *arena, dlu_mem_block_t *block) {
+  uint32_t bin = bin_floor(block->size);
+  arena->released += block->size;
+
+  block->abytes = block->size;
+  block->prv_addr = arena->bins[bin];
+  arena->bins[bin] = block;
+  arena->bin_map |= (1UL << bin);
+}
+
+/**
+* Split the tail of a block passed bytes into a new released block.
+* Only done when the tail can hold metadata and a minimum sized block.
+*/
+static void split_block(dlu_arena *arena, dlu_mem_block_t *block, size_t bytes) {
+  if (block->size < (bytes + block_cost(0, 1))) return;
+
+  dlu_mem_block_t *split = block->saddr + bytes;
+  split->arena = arena;
+  split->next = block->next;
+  split->size = block->size - bytes - BLOCK_SIZE;
+  split->saddr = BLOCK_SIZE + (void *) split;
+
+  block->next = split;
+  block->size = bytes;
+
+  /* Keep small_block pointing at the block right before the next unallocated one */
+  if (arena->small_block == block) arena->small_block = split;
+
+  put_bin_block(arena, split);
+}
+
+/**
+* O(1) lookup of a released block. Find the first non-empty
+* size class that satisfies the request and pop its head.
 */
-static void *sstart_addr_priv = NULL;
-static dlu_mem_block_t *large_block_priv = NULL;
-static dlu_mem_block_t *small_block_priv = NULL;
+static dlu_mem_block_t *take_bin_block(dlu_arena *arena, size_t bytes) {
+  dlu_mem_block_t *block = NULL;
+  uint64_t map = arena->bin_map & (~0UL << bin_ceil(bytes));
+  if (!map) return NULL;
+
+  uint32_t bin = __builtin_ctzl(map);
+  block = arena->bins[bin];
+
+  /* Only the last size class can hold blocks smaller than the request */
+  if (block->size < bytes) return NULL;
+
+  arena->bins[bin] = block->prv_addr;
+  if (!arena->bins[bin]) arena->bin_map &= ~(1UL << bin);
+
+  arena->released -= block->size;
+  block->abytes = 0;
+  split_block(arena, block, bytes);
+
+  /* Keep the guarantee that allocated memory is zeroed */
+  memset(block->saddr, 0, block->size);
+
+  return block;
+}
+
+/* Index of a dlu_data_type in otba_bytes and dlu_mem_stats */
+static int otba_index(dlu_data_type type) {
+  switch (type) {
+    case DLU_SC_DATA: case DLU_GP_DATA: case DLU_CMD_DATA: case DLU_BUFF_DATA:
+    case DLU_DESC_DATA: case DLU_TEXT_DATA: case DLU_PD_DATA: case DLU_LD_DATA:
+      return type;
+    case DLU_SC_DATA_MEMS: return 8;
+    case DLU_DESC_DATA_MEMS: return 9;
+    case DLU_GP_DATA_MEMS: return 10;
+    case DLU_DEVICE_OUTPUT_DATA: return 11;
+    case DLU_DEVICE_OUTPUT_BUFF_DATA: return 12;
+    default: return NEG_ONE;
+  }
+}
+
+static void note_peak(dlu_arena *arena) {
+  if ((arena->consumed - arena->released) > arena->peak)
+    arena->peak = arena->consumed - arena->released;
+}
+
+/* Counters are plain adds, cheap enough to always keep */
+static void *note_alloc(dlu_arena *arena, void *ptr) {
+  if (!ptr) return NULL;
 
-static void *sstart_addr_shared = NULL;
-static dlu_mem_block_t *large_block_shared = NULL;
-static dlu_mem_block_t *small_block_shared = NULL;
+  arena->alloc_cnt++;
+  note_peak(arena);
+
+  return ptr;
+}
+
+static dlu_mem_block_t *chain_mem_block(dlu_arena *arena, size_t bytes);
 
 /**
 * Helps in ensuring one does not waste cycles in context switching
 * First check if sub-block was allocated and is currently free
 * If block not free, sub allocate more from larger memory block
 */
-static dlu_mem_block_t *get_free_block(dlu_block_type type, size_t bytes) {
+static dlu_mem_block_t *get_free_block(dlu_arena *arena, size_t bytes) {
   dlu_mem_block_t *current = NULL;
-  size_t abytes = 0;
 
   /**
   * This allows for O(1) allocation
-  * If next block doesn't exists use large_block_priv/shared->saddr address
+  * If next block doesn't exists use arena->sstart_addr address
   * else set current to next block (which would be the block waiting to be allocated)
   */
-  switch(type) {
-    case DLU_SMALL_BLOCK_PRIV:
-      abytes = large_block_priv->abytes;
-      current = (!small_block_priv->next) ? sstart_addr_priv : small_block_priv->next;
-      break;
-    case DLU_SMALL_BLOCK_SHARED:
-      abytes = large_block_shared->abytes;
-      current = (!small_block_shared->next) ? sstart_addr_shared : small_block_shared->next;
-      break;
-    default: break;
-  }
+  current = (!arena->small_block->next) ? arena->sstart_addr : arena->small_block->next;
+
+  /* Current chunk is exhausted, continue the list in a new chunk */
+  if (arena->chunk->abytes < (BLOCK_SIZE + bytes) && arena->flags & DLU_BLOCK_CHAINED)
+    current = chain_mem_block(arena, bytes);
 
   /* An extra check, although this should never be NULL */
   if (!current) return NULL;
 
-  if (abytes >= bytes) {
+  /* Account for the metadata of the block that follows this one */
+  if (arena->chunk->abytes >= (BLOCK_SIZE + bytes)) {
     /* current block thats about to be allocated set few metadata */
-    dlu_mem_block_t *block = current->addr;
+    dlu_mem_block_t *block = current;
     block->size = bytes;
+    block->arena = arena;
     /* Put saddr at an address that doesn't contain metadata */
-    block->saddr = BLOCK_SIZE + current->addr;
+    block->saddr = BLOCK_SIZE + (void *) current;
 
     /**
     * Set next blocks metadata
@@ -111,22 +343,19 @@ static dlu_mem_block_t *get_free_block(dlu_block_type type, size_t bytes) {
     * to be the starting address of the next block not the current one.
     * Basically offset the memory address. Thus, allocating space.
     */
-    block = current->addr + BLOCK_SIZE + bytes;
+    block = (void *) current + BLOCK_SIZE + bytes;
 
     /* set next block meta data */
-    block->addr = block;
+    block->arena = NULL;
     block->next = NULL;
     block->size = 0;
     block->abytes = 0;
     block->saddr = NULL;
-    block->prv_addr = current->addr;
+    block->prv_addr = current;
 
     /* Decrement larger block available memory */
-    switch(type) {
-      case DLU_SMALL_BLOCK_SHARED: large_block_shared->abytes -= (BLOCK_SIZE + bytes); break;
-      case DLU_SMALL_BLOCK_PRIV: large_block_priv->abytes -= (BLOCK_SIZE + bytes); break;
-      default: break;
-    }
+    arena->chunk->abytes -= (BLOCK_SIZE + bytes);
+    arena->consumed += (BLOCK_SIZE + bytes);
 
     return block;
   }
@@ -134,119 +363,782 @@ static dlu_mem_block_t *get_free_block(dlu_block_type type, size_t bytes) {
   return NULL;
 }
 
-static dlu_mem_block_t *alloc_mem_block(dlu_block_type type, size_t bytes) {
-  dlu_mem_block_t *block = NULL;
+/* Write large block metadata at the start of a region of BLOCK_SIZE + bytes */
+static dlu_mem_block_t *set_large_block(void *addr, size_t bytes) {
+  dlu_mem_block_t *block = addr;
 
-  /* Allows for zeros to be written into values of bytes allocated */
-  int fd = open("/dev/zero", O_RDWR);
-  if (fd == NEG_ONE) {
-    dlu_log_me(DLU_DANGER, "[x] open: %s", strerror(errno));
-    goto finish_alloc_mem_block;
-  }
+  block->next = NULL;
+  block->size = block->abytes = bytes;
+
+  /* Put saddr at an address that doesn't contain metadata */
+  block->arena = NULL;
+  block->saddr = BLOCK_SIZE + addr;
+  block->prv_addr = NULL;
+
+  return block;
+}
+
+/**
+* Anonymous mappings are already zero filled. dlu_block_flags decide whether
+* pages are backed by huge pages, faulted in up front and locked in memory.
+*/
+static dlu_mem_block_t *alloc_mem_block(dlu_block_type type, size_t bytes, uint32_t bflags) {
+  dlu_mem_block_t *block = MAP_FAILED;
+
+  /* Pages are mapped whole, so let the block use the tail of the last page */
+  size_t page_size = (bflags & DLU_BLOCK_HUGE_PAGES) ? HUGE_PAGE_SIZE : (size_t) sysconf(_SC_PAGESIZE);
+  bytes = (((BLOCK_SIZE + bytes) + page_size - 1) & ~(page_size - 1)) - BLOCK_SIZE;
 
   /* Can only allocate up to 8GB, 2^33, or 1ULL << 33 */
   int flags = (type == DLU_LARGE_BLOCK_SHARED) ? MAP_SHARED : MAP_PRIVATE;
-  block = mmap(NULL, BLOCK_SIZE + bytes, PROT_READ | PROT_WRITE, flags | MAP_ANONYMOUS, fd, 0);
+  flags |= MAP_ANONYMOUS | ((bflags & DLU_BLOCK_POPULATE) ? MAP_POPULATE : 0);
+
+  /* Explicit huge pages need a reserved pool, fall back to transparent huge pages */
+  if (bflags & DLU_BLOCK_HUGE_PAGES)
+    block = mmap(NULL, BLOCK_SIZE + bytes, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+
   if (block == MAP_FAILED) {
+    block = mmap(NULL, BLOCK_SIZE + bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (block == MAP_FAILED) {
+      dlu_log_me(DLU_DANGER, "[x] mmap: %s", strerror(errno));
+      return NULL;
+    }
+
+    if (bflags & DLU_BLOCK_HUGE_PAGES && madvise(block, BLOCK_SIZE + bytes, MADV_HUGEPAGE) == NEG_ONE)
+      dlu_log_me(DLU_WARNING, "[x] madvise: %s", strerror(errno));
+  }
+
+  /* Not fatal, the block is still usable when RLIMIT_MEMLOCK is too low */
+  if (bflags & DLU_BLOCK_MLOCK && mlock(block, BLOCK_SIZE + bytes) == NEG_ONE)
+    dlu_log_me(DLU_WARNING, "[x] mlock: %s", strerror(errno));
+
+  set_large_block(block, bytes);
+  return block;
+}
+
+/**
+* The exported block is a memfd that only holds small block data. Other processes can write
+* to it, so the large block metadata, side table and free list links are kept in private
+* pages around the memfd mapping. The block is always header-less. Reserved range:
+* | private page (metadata at its end) | payload (memfd) | side table | free list links |
+*/
+static dlu_mem_block_t *alloc_shared_block(size_t bytes, uint32_t bflags, int fd) {
+  dlu_mem_block_t *block = NULL;
+  void *addr = MAP_FAILED, *payload = MAP_FAILED;
+
+  size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+  bytes = (bytes + page_size - 1) & ~(page_size - 1);
+
+  size_t granules = bytes / BLOCK_ALIGN;
+  size_t meta = (granules + (granules * sizeof(void *)) + page_size - 1) & ~(page_size - 1);
+
+  /* Processes attaching to the file can trust its size to never change */
+  if (ftruncate(fd, bytes) == NEG_ONE) {
+    dlu_log_me(DLU_DANGER, "[x] ftruncate: %s", strerror(errno));
+    return NULL;
+  }
+
+  if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == NEG_ONE)
+    dlu_log_me(DLU_WARNING, "[x] fcntl: %s", strerror(errno));
+
+  addr = mmap(NULL, page_size + bytes + meta, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
     dlu_log_me(DLU_DANGER, "[x] mmap: %s", strerror(errno));
-    goto finish_alloc_mem_block;
+    return NULL;
   }
 
-  block->next = NULL;
-  block->size = block->abytes = bytes;
+  /* Replace the payload pages of the reservation with the memfd */
+  payload = mmap(addr + page_size, bytes, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED | ((bflags & DLU_BLOCK_POPULATE) ? MAP_POPULATE : 0), fd, 0);
+  if (payload == MAP_FAILED) {
+    dlu_log_me(DLU_DANGER, "[x] mmap: %s", strerror(errno));
+    munmap(addr, page_size + bytes + meta);
+    return NULL;
+  }
+
+  if (bflags & DLU_BLOCK_HUGE_PAGES && madvise(payload, bytes, MADV_HUGEPAGE) == NEG_ONE)
+    dlu_log_me(DLU_WARNING, "[x] madvise: %s", strerror(errno));
+
+  if (bflags & DLU_BLOCK_MLOCK && mlock(addr, page_size + bytes + meta) == NEG_ONE)
+    dlu_log_me(DLU_WARNING, "[x] mlock: %s", strerror(errno));
+
+  block = set_large_block(payload - BLOCK_SIZE, bytes + meta);
+  block->prv_addr = payload + bytes;
+  block->abytes = bytes;
 
-  /* Put saddr at an address that doesn't contain metadata */
-  block->addr = block;
-  block->saddr = BLOCK_SIZE + block;
-finish_alloc_mem_block:
-  if (close(fd) == NEG_ONE)
-    dlu_log_me(DLU_DANGER, "[x] close: %s", strerror(errno));
   return block;
 }
 
+/**
+* Header-less chunks don't store metadata with each small block
+* | dlu_mem_block_t | payload (granule count * BLOCK_ALIGN) | side table (one byte per granule) |
+* saddr    | Start of the payload
+* abytes   | Bytes left at the end of the payload
+* prv_addr | Start of the side table, also the end of the payload
+* A side table entry is 0 for granules that don't start a block. Otherwise it is the
+* block's size class + 1, with HL_RELEASED set while the block sits in a free list.
+*/
+#define HL_RELEASED 0x80
+
+static void set_hl_chunk(dlu_mem_block_t *chunk) {
+  size_t granules = chunk->abytes / (BLOCK_ALIGN + 1);
+
+  chunk->prv_addr = chunk->saddr + (granules * BLOCK_ALIGN);
+  chunk->abytes = granules * BLOCK_ALIGN;
+  memset(chunk->prv_addr, 0, granules);
+}
+
+/* Chunk containing ptr. The amount of chunks grows logarithmically in chained mode */
+static dlu_mem_block_t *find_hl_chunk(dlu_arena *arena, void *ptr) {
+  for (dlu_mem_block_t *chunk = arena->large_block; chunk; chunk = chunk->next)
+    if (ptr >= chunk->saddr && ptr < chunk->prv_addr)
+      return chunk;
+  return NULL;
+}
+
+/**
+* Set small block allocation addr to address that doesn't include larger block metadata
+* The first small block only holds metadata so reserve space for it
+*/
+static void set_arena(dlu_arena *arena, dlu_mem_block_t *large_block) {
+  arena->bin_map = 0;
+  memset(arena->bins, 0, sizeof(arena->bins));
+
+  arena->reserved = BLOCK_SIZE + large_block->size;
+  arena->consumed = arena->released = arena->peak = 0;
+  arena->alloc_cnt = arena->free_cnt = 0;
+
+  if (arena->flags & DLU_BLOCK_HEADERLESS) {
+    arena->large_block = arena->chunk = large_block;
+    arena->small_block = arena->sstart_addr = NULL;
+
+    /* alloc_shared_block() already placed the side table */
+    if (!large_block->prv_addr) set_hl_chunk(large_block);
+    return;
+  }
+
+  arena->large_block = arena->chunk = large_block;
+  arena->large_block->abytes = (large_block->abytes > BLOCK_SIZE) ? large_block->abytes - BLOCK_SIZE : 0;
+
+  arena->small_block = arena->sstart_addr = large_block->saddr;
+  memset(arena->small_block, 0, BLOCK_SIZE);
+}
+
+/**
+* Map a new chunk at least twice the size of the current one and link it to the chain.
+* Geometric growth keeps the amount of mmap(2) calls logarithmic so allocation stays O(1)
+* amortized. The leftover bytes of the previous chunk are not used again.
+* Returns the first small block of the new chunk, it continues the arena's small block list.
+*/
+static dlu_mem_block_t *chain_mem_block(dlu_arena *arena, size_t bytes) {
+  dlu_mem_block_t *nblock = NULL, *block = NULL;
+  size_t size = arena->chunk->size << 1;
+
+  /* Make sure the chunk can hold the request along with the small blocks metadata */
+  if (size < (BLOCK_SIZE + BLOCK_SIZE + bytes))
+    size = BLOCK_SIZE + BLOCK_SIZE + bytes;
+
+  nblock = alloc_mem_block((arena->type == DLU_SMALL_BLOCK_SHARED) ? DLU_LARGE_BLOCK_SHARED : DLU_LARGE_BLOCK_PRIV, size, arena->flags);
+  if (!nblock) return NULL;
+
+  /* First small block only holds metadata */
+  nblock->abytes -= BLOCK_SIZE;
+  arena->reserved += BLOCK_SIZE + nblock->size;
+  arena->chunk->next = nblock;
+  arena->chunk = nblock;
+
+  block = nblock->saddr;
+  memset(block, 0, BLOCK_SIZE);
+  block->prv_addr = arena->small_block;
+  arena->small_block->next = block;
+
+  return block;
+}
+
+/* Worst case bytes dlu_alloc_aligned(3) takes from the large block, including padding */
+static size_t align_cost(uint32_t flags, size_t bytes, size_t align) {
+  if (align <= BLOCK_ALIGN) return block_cost(flags, bytes);
+
+  if (flags & DLU_BLOCK_HEADERLESS)
+    return block_cost(flags, bytes) + align + (align / BLOCK_ALIGN);
+
+  return block_cost(flags, class_round(bytes) + align + BLOCK_SIZE);
+}
+
+/* Same as chain_mem_block(), for an arena in header-less mode */
+static dlu_mem_block_t *chain_hl_chunk(dlu_arena *arena, size_t bytes) {
+  dlu_mem_block_t *nblock = NULL;
+  size_t size = arena->chunk->size << 1;
+
+  /* Make sure the chunk can hold the request along with its side table */
+  if (size < (bytes + (bytes / BLOCK_ALIGN) + BLOCK_ALIGN + 1))
+    size = bytes + (bytes / BLOCK_ALIGN) + BLOCK_ALIGN + 1;
+
+  nblock = alloc_mem_block((arena->type == DLU_SMALL_BLOCK_SHARED) ? DLU_LARGE_BLOCK_SHARED : DLU_LARGE_BLOCK_PRIV, size, arena->flags);
+  if (!nblock) return NULL;
+
+  set_hl_chunk(nblock);
+  arena->reserved += BLOCK_SIZE + nblock->size;
+  arena->chunk->next = nblock;
+  arena->chunk = nblock;
+
+  return nblock;
+}
+
+/* Take a block of a size class from the end of the current chunk. Caller checks for room */
+static void *hl_bump(dlu_arena *arena, uint32_t bin) {
+  dlu_mem_block_t *chunk = arena->chunk;
+  uint8_t *table = chunk->prv_addr;
+  void *ptr = chunk->prv_addr - chunk->abytes;
+
+  chunk->abytes -= bin_size(bin);
+  arena->consumed += bin_size(bin);
+  table[(ptr - chunk->saddr) / BLOCK_ALIGN] = bin + 1;
+
+  /* Private chunks are untouched since mmap, other processes may have written to the exported one */
+  if (arena == &shared_arena) memset(ptr, 0, bin_size(bin));
+
+  return ptr;
+}
+
+/**
+* Where the free list link of a released header-less block is kept. Normally its first
+* bytes, but the exported block's payload is writable by other processes so its links
+* are kept in the private pages after the side table.
+*/
+static void **hl_link(dlu_arena *arena, void *ptr) {
+  dlu_mem_block_t *chunk = arena->large_block;
+  if (arena != &shared_arena || ptr < chunk->saddr || ptr >= chunk->prv_addr)
+    return ptr;
+
+  size_t granules = (chunk->prv_addr - chunk->saddr) / BLOCK_ALIGN;
+  void **links = chunk->prv_addr + granules;
+  return &links[(ptr - chunk->saddr) / BLOCK_ALIGN];
+}
+
+/**
+* Header-less allocation. Requests are rounded up to their size class, so the
+* class stored in the side table is enough to know a block's size. A released
+* block of the same class is reused first, else the chunk's payload is bumped.
+*/
+static void *hl_alloc(dlu_arena *arena, size_t bytes) {
+  dlu_mem_block_t *chunk = arena->chunk;
+  uint8_t *table = NULL;
+  void *ptr = NULL;
+
+  uint32_t bin = bin_ceil(block_round(bytes));
+  size_t size = bin_size(bin);
+
+  /* The last size class isn't bounded, its blocks can't be described by the side table */
+  if (size < bytes) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  if (arena->bins[bin]) {
+    ptr = arena->bins[bin];
+    arena->bins[bin] = *hl_link(arena, ptr);
+    if (!arena->bins[bin]) arena->bin_map &= ~(1UL << bin);
+
+    arena->released -= size;
+    chunk = find_hl_chunk(arena, ptr);
+    table = chunk->prv_addr;
+    table[(ptr - chunk->saddr) / BLOCK_ALIGN] &= ~HL_RELEASED;
+
+    /* Keep the guarantee that allocated memory is zeroed */
+    memset(ptr, 0, size);
+    return ptr;
+  }
+
+  if (chunk->abytes < size) {
+    if (!(arena->flags & DLU_BLOCK_CHAINED)) return NULL;
+    chunk = chain_hl_chunk(arena, size);
+    if (!chunk) return NULL;
+  }
+
+  return hl_bump(arena, bin);
+}
+
+/* Side table entry of a block in use, NULL if ptr isn't one */
+static uint8_t *hl_entry(dlu_arena *arena, void *ptr) {
+  dlu_mem_block_t *chunk = find_hl_chunk(arena, ptr);
+  if (!chunk || (ptr - chunk->saddr) % BLOCK_ALIGN) return NULL;
+
+  uint8_t *entry = chunk->prv_addr + ((ptr - chunk->saddr) / BLOCK_ALIGN);
+  if (!*entry || *entry & HL_RELEASED) return NULL;
+
+  return entry;
+}
+
+static bool hl_free(dlu_arena *arena, void *ptr) {
+  uint8_t *entry = hl_entry(arena, ptr);
+  if (!entry) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return false; }
+
+  uint32_t bin = *entry - 1;
+  *entry |= HL_RELEASED;
+  arena->released += bin_size(bin);
+
+  /* Link is stored in the released payload */
+  *hl_link(arena, ptr) = arena->bins[bin];
+  arena->bins[bin] = ptr;
+  arena->bin_map |= (1UL << bin);
+
+  return true;
+}
+
+/**
+* Header-less blocks can't start in the middle of a granule run, so pad the end of
+* the chunk with filler blocks up to the alignment. Fillers are released right away
+* and get reused by later requests of their size class.
+*/
+static void *hl_alloc_aligned(dlu_arena *arena, size_t bytes, size_t align) {
+  dlu_mem_block_t *chunk = arena->chunk;
+  uint32_t bin = bin_ceil(block_round(bytes)), fbin = 0;
+  size_t pad = 0;
+
+  if (bin_size(bin) < bytes) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  if (chunk->abytes < (bin_size(bin) + align)) {
+    if (!(arena->flags & DLU_BLOCK_CHAINED)) return NULL;
+    chunk = chain_hl_chunk(arena, bin_size(bin) + align);
+    if (!chunk) return NULL;
+  }
+
+  pad = -(uintptr_t) (chunk->prv_addr - chunk->abytes) & (align - 1);
+  while (pad) {
+    fbin = bin_floor(pad);
+    hl_free(arena, hl_bump(arena, fbin));
+    pad -= bin_size(fbin);
+  }
+
+  return hl_bump(arena, bin);
+}
+
+static void *hl_realloc(dlu_arena *arena, void *ptr, size_t bytes) {
+  uint8_t *entry = hl_entry(arena, ptr);
+  if (!entry) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  /* Still fits in its size class. Zero passed the new length, a later grow hands those bytes out */
+  size_t size = bin_size(*entry - 1);
+  if (bytes <= size) {
+    memset(ptr + bytes, 0, size - bytes);
+    return ptr;
+  }
+
+  /* Counted like a header-ful move, one allocation and one release */
+  void *nptr = note_alloc(arena, hl_alloc(arena, bytes));
+  if (!nptr) return NULL;
+
+  memcpy(nptr, ptr, size);
+  if (hl_free(arena, ptr)) arena->free_cnt++;
+
+  return nptr;
+}
+
+/**
+* Unmap every chunk in a chain starting from block. The exported block's
+* metadata sits at the end of the first page of its mapping.
+*/
+static bool release_chunks(dlu_mem_block_t *block) {
+  dlu_mem_block_t *next = NULL;
+  uintptr_t page_mask = (uintptr_t) sysconf(_SC_PAGESIZE) - 1;
+
+  while (block) {
+    next = block->next;
+    void *addr = (void *) ((uintptr_t) block & ~page_mask);
+    if (munmap(addr, ((void *) block - addr) + BLOCK_SIZE + block->size) == NEG_ONE) {
+      dlu_log_me(DLU_DANGER, "[x] munmap: %s", strerror(errno));
+      return false;
+    }
+    block = next;
+  }
+
+  return true;
+}
+
+/**
+* O(1) appending to end of linked-list
+* Retrieve last used memory block and set it to the newly allocated one
+*/
+static void *arena_alloc(dlu_arena *arena, size_t bytes) {
+  dlu_mem_block_t *nblock = NULL;
+
+  /* If large block not allocated return NULL until allocated */
+  if (!arena->large_block) return NULL;
+
+  if (arena->flags & DLU_BLOCK_HEADERLESS)
+    return note_alloc(arena, hl_alloc(arena, bytes));
+
+  bytes = class_round(bytes);
+
+  /* First check if a released block can be reused */
+  nblock = take_bin_block(arena, bytes);
+  if (nblock) return note_alloc(arena, nblock->saddr);
+
+  nblock = get_free_block(arena, bytes);
+  if (!nblock) return NULL;
+
+  /* set small block list to address of the previous block in the list */
+  arena->small_block = nblock->prv_addr;
+  arena->small_block->next = nblock;
+
+  /* Move back to previous block (for return status) */
+  return note_alloc(arena, arena->small_block->saddr);
+}
+
+static void arena_free(dlu_arena *arena, void *ptr) {
+  if (!ptr || !arena->large_block) return;
+
+  if (arena->flags & DLU_BLOCK_HEADERLESS) {
+    if (hl_free(arena, ptr)) arena->free_cnt++;
+    return;
+  }
+
+  dlu_mem_block_t *block = ptr - BLOCK_SIZE;
+
+  /* Catch pointers not returned by an allocation of this arena and blocks already released */
+  if (block->saddr != ptr || block->abytes || block->arena != arena) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return; }
+
+  put_bin_block(arena, block);
+  arena->free_cnt++;
+}
+
+/**
+* Over allocate by the alignment plus room for a block in front. The front of the
+* block up to the aligned address is split off into its own released block.
+*/
+static void *arena_alloc_aligned(dlu_arena *arena, size_t bytes, size_t align) {
+  dlu_mem_block_t *block = NULL, *nblock = NULL;
+  void *ptr = NULL, *aptr = NULL;
+
+  if (align <= BLOCK_ALIGN) return arena_alloc(arena, bytes);
+  if (!arena->large_block) return NULL;
+
+  if (arena->flags & DLU_BLOCK_HEADERLESS)
+    return note_alloc(arena, hl_alloc_aligned(arena, bytes, align));
+
+  bytes = class_round(bytes);
+  ptr = arena_alloc(arena, bytes + align + BLOCK_SIZE);
+  if (!ptr) return NULL;
+
+  block = ptr - BLOCK_SIZE;
+  if (!((uintptr_t) ptr & (align - 1))) {
+    split_block(arena, block, bytes);
+    return ptr;
+  }
+
+  /* Front block needs room for metadata and a minimum sized block */
+  aptr = (void *) (((uintptr_t) ptr + BLOCK_SIZE + BLOCK_ALIGN + align - 1) & ~((uintptr_t) align - 1));
+
+  nblock = aptr - BLOCK_SIZE;
+  nblock->arena = arena;
+  nblock->next = block->next;
+  nblock->size = (block->saddr + block->size) - aptr;
+  nblock->abytes = 0;
+  nblock->saddr = aptr;
+  nblock->prv_addr = NULL;
+
+  block->next = nblock;
+  block->size = (void *) nblock - block->saddr;
+
+  if (arena->small_block == block) arena->small_block = nblock;
+
+  put_bin_block(arena, block);
+  split_block(arena, nblock, bytes);
+
+  return aptr;
+}
+
+static void *arena_realloc(dlu_arena *arena, void *ptr, size_t bytes) {
+  if (!ptr) return arena_alloc(arena, bytes);
+  if (!arena->large_block) return NULL;
+
+  if (arena->flags & DLU_BLOCK_HEADERLESS)
+    return hl_realloc(arena, ptr, bytes);
+
+  dlu_mem_block_t *block = ptr - BLOCK_SIZE, *next = NULL;
+  if (block->saddr != ptr || block->abytes || block->arena != arena) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  size_t req = bytes;
+  bytes = class_round(bytes);
+
+  /**
+  * Shrinking, hand the tail back to the free lists. What's left passed the requested
+  * length is zeroed, a later grow that still fits returns it without clearing it.
+  */
+  if (bytes <= block->size) {
+    split_block(arena, block, bytes);
+    memset(ptr + req, 0, block->size - req);
+    return ptr;
+  }
+
+  /**
+  * Last allocated block can grow in place when the next unallocated
+  * block directly follows it and the current chunk has room left.
+  */
+  if (arena->small_block == block && block->next == (block->saddr + block->size) &&
+      arena->chunk->abytes >= (bytes - block->size)) {
+    memset(block->saddr + block->size, 0, bytes - block->size);
+    arena->chunk->abytes -= (bytes - block->size);
+    arena->consumed += (bytes - block->size);
+    block->size = bytes;
+    note_peak(arena);
+
+    /* Move the next unallocated block's metadata passed the grown block */
+    next = block->saddr + bytes;
+    memset(next, 0, BLOCK_SIZE);
+    next->prv_addr = block;
+    block->next = next;
+    return ptr;
+  }
+
+  void *nptr = arena_alloc(arena, bytes);
+  if (!nptr) return NULL;
+
+  memcpy(nptr, ptr, block->size);
+  arena_free(arena, ptr);
+
+  return nptr;
+}
+
+/* Create the large block of a process wide arena. Lock must be held */
+static void *set_global_block(dlu_arena *arena, dlu_block_type type, size_t bytes, uint32_t flags) {
+  dlu_mem_block_t *nblock = NULL;
+  int fd = NEG_ONE;
+
+  /* If large block allocated don't allocate another one */
+  if (arena->large_block) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return NULL; }
+
+  /* Shared block is backed by a memfd so unrelated processes can attach to it */
+  if (type == DLU_LARGE_BLOCK_SHARED) {
+    fd = memfd_create("lucur-shared-block", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == NEG_ONE) { dlu_log_me(DLU_DANGER, "[x] memfd_create: %s", strerror(errno)); return NULL; }
+  }
+
+  nblock = (fd == NEG_ONE) ? alloc_mem_block(type, bytes, flags) : alloc_shared_block(bytes, flags, fd);
+  if (!nblock) {
+    if (fd != NEG_ONE) close(fd);
+    return NULL;
+  }
+
+  if (type == DLU_LARGE_BLOCK_SHARED) shared_fd = fd;
+
+  arena->flags = flags;
+  set_arena(arena, nblock);
+
+  return nblock->saddr;
+}
+
 /**
 * This function is reserve for one time use. Only used when allocating space for struct members
 * It works similiar to how sbrk works. Basically it creates a new block of memory, but it returns
 * the ending address of the previous block.
 */
 void *dlu_alloc(dlu_block_type type, size_t bytes) {
-  dlu_mem_block_t *nblock = NULL;
+  pthread_mutex_t *lock = NULL;
+  void *saddr = NULL;
+
+  dlu_arena *arena = get_arena(type, &lock);
+  if (!arena) return NULL;
+
+  /* Thread bound arena, no locking needed */
+  if (!lock) return arena_alloc(arena, bytes);
+
+  pthread_mutex_lock(lock);
 
   /**
   * This will create large block of memory
   * Then create a linked list of smaller blocks from the larger one
-  * Retrieve last used memory block
-  * O(1) appending to end of linked-list
-  * reset linked list to starting address of linked list
   */
-
-  /* TODO: Possible rewrite of switch statement */
   switch (type) {
     case DLU_LARGE_BLOCK_PRIV:
-      /* If large block allocated don't allocate another one */
-      if (large_block_priv) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return NULL; }
-
-      nblock = alloc_mem_block(type, bytes);
-      if (!nblock) return NULL;
-      large_block_priv = nblock;
-
-      /**
-      * Set small block allocation addr to address that
-      * doesn't include larger block metadata
-      */
-      small_block_priv = sstart_addr_priv = nblock->saddr;
-      small_block_priv->addr = small_block_priv;
+    case DLU_LARGE_BLOCK_SHARED:
+      saddr = set_global_block(arena, type, bytes, 0);
       break;
     case DLU_SMALL_BLOCK_PRIV:
-      /* If large block not allocated return NULL until allocated */
-      if (!large_block_priv) return NULL;
+    case DLU_SMALL_BLOCK_SHARED:
+      saddr = arena_alloc(arena, bytes);
+      break;
+    default: break;
+  }
 
-      nblock = get_free_block(type, bytes);
-      if (!nblock) return NULL;
+  pthread_mutex_unlock(lock);
 
-      /* set small block list to address of the previous block in the list */
-      small_block_priv = nblock->prv_addr;
-      small_block_priv->next = nblock;
+  return saddr;
+}
 
-      /* Move back to previous block (for return status) */
-      nblock = small_block_priv;
-      break;
+/**
+* Release a small block so it can be reused by a later allocation of the same type.
+* The block must come from the arena dlu_alloc(3) would pick for type on the calling thread,
+* blocks handed out by any other arena are rejected.
+*/
+void dlu_free(dlu_block_type type, void *ptr) {
+  pthread_mutex_t *lock = NULL;
+
+  if (type != DLU_SMALL_BLOCK_PRIV && type != DLU_SMALL_BLOCK_SHARED) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return; }
+
+  dlu_arena *arena = get_arena(type, &lock);
+  if (lock) pthread_mutex_lock(lock);
+  arena_free(arena, ptr);
+  if (lock) pthread_mutex_unlock(lock);
+}
+
+/**
+* Same as dlu_alloc(3), but the returned address is a multiple of align. Only powers
+* of two up to the page size are honored. Padding in front of the block is released.
+*/
+void *dlu_alloc_aligned(dlu_block_type type, size_t bytes, size_t align) {
+  pthread_mutex_t *lock = NULL;
+  void *saddr = NULL;
+
+  if (type != DLU_SMALL_BLOCK_PRIV && type != DLU_SMALL_BLOCK_SHARED) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  /* Alignment must be a power of two no larger than a page */
+  if (!align || (align & (align - 1)) || align > (size_t) sysconf(_SC_PAGESIZE)) {
+    PERR(DLU_OP_NOT_PERMITED, 0, NULL);
+    return NULL;
+  }
+
+  dlu_arena *arena = get_arena(type, &lock);
+  if (lock) pthread_mutex_lock(lock);
+  saddr = arena_alloc_aligned(arena, bytes, align);
+  if (lock) pthread_mutex_unlock(lock);
+
+  return saddr;
+}
+
+/**
+* Resize a small block. Data up to the smaller of the two sizes is kept and any new bytes are zeroed.
+* A NULL ptr behaves like dlu_alloc(3). On failure NULL is returned and ptr is left untouched.
+* Like dlu_free(3), ptr must come from the arena dlu_alloc(3) would pick for type.
+*/
+void *dlu_realloc(dlu_block_type type, void *ptr, size_t bytes) {
+  pthread_mutex_t *lock = NULL;
+  void *saddr = NULL;
+
+  if (type != DLU_SMALL_BLOCK_PRIV && type != DLU_SMALL_BLOCK_SHARED) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  dlu_arena *arena = get_arena(type, &lock);
+  if (lock) pthread_mutex_lock(lock);
+  saddr = arena_realloc(arena, ptr, bytes);
+  if (lock) pthread_mutex_unlock(lock);
+
+  return saddr;
+}
+
+/**
+* Arenas are meant to be owned by one thread. Their state is stored
+* at the start of their own large block so no extra allocation is needed.
+* DLU_LARGE_BLOCK_PRIV/DLU_LARGE_BLOCK_SHARED: Arena maps its own large block
+* DLU_SMALL_BLOCK_PRIV/DLU_SMALL_BLOCK_SHARED: Arena is carved from the dlu_otma(3) large block
+*/
+dlu_arena *dlu_arena_create(dlu_block_type type, size_t bytes) {
+  dlu_mem_block_t *nblock = NULL;
+  dlu_arena *arena = NULL, *parent = NULL, *global = NULL;
+  pthread_mutex_t *lock = NULL;
+  void *saddr = NULL;
+  uint32_t flags = 0;
+
+  bool priv = (type == DLU_LARGE_BLOCK_PRIV || type == DLU_SMALL_BLOCK_PRIV);
+
+  /* Arena state would sit in the exported block where other processes can write it */
+  if (type == DLU_SMALL_BLOCK_SHARED) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return NULL; }
+
+  /* Inherit the flags of the process wide arena, dlu_otma(3) and dlu_release_blocks(3) change them */
+  global = get_global_arena(type, &lock);
+  if (!global) return NULL;
+
+  pthread_mutex_lock(lock);
+  flags = global->flags;
+  pthread_mutex_unlock(lock);
+
+  /* Arena state and the first small block metadata are stored in the large block */
+  size_t size = block_round(sizeof(dlu_arena)) + BLOCK_SIZE + bytes;
+  if (flags & DLU_BLOCK_HEADERLESS) size += bytes / BLOCK_ALIGN; /* side table */
+
+  switch (type) {
+    case DLU_LARGE_BLOCK_PRIV:
     case DLU_LARGE_BLOCK_SHARED:
-      /* If large block allocated don't allocate another one */
-      if (large_block_shared) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return NULL; }
-
-      nblock = alloc_mem_block(type, bytes);
-      if (!nblock) return NULL;
-      large_block_shared = nblock;
-
-      /**
-      * Set small block allocation addr to address that
-      * doesn't include larger block metadata
-      */
-      small_block_shared = sstart_addr_shared = nblock->saddr;
-      small_block_shared->addr = small_block_shared;
+      nblock = alloc_mem_block(type, size, flags);
       break;
+    case DLU_SMALL_BLOCK_PRIV:
     case DLU_SMALL_BLOCK_SHARED:
-      /* If large block not allocated return NULL until allocated */
-      if (!large_block_shared) return NULL;
-
-      nblock = get_free_block(type, bytes);
-      if (!nblock) return NULL;
+      parent = global;
 
-      /* set small block list to address of the previous block in the list */
-      small_block_shared = nblock->prv_addr;
-      small_block_shared->next = nblock;
+      pthread_mutex_lock(lock);
+      saddr = arena_alloc(parent, BLOCK_SIZE + size);
+      pthread_mutex_unlock(lock);
 
-      /* Move back to previous block (for return status) */
-      nblock = small_block_shared;
+      if (!saddr) { PERR(DLU_ALLOC_FAILED, 0, NULL); return NULL; }
+      nblock = set_large_block(saddr, size);
       break;
     default: break;
   }
 
-  return nblock->saddr;
+  if (!nblock) return NULL;
+
+  /* Move large block saddr passed the arena state */
+  arena = nblock->saddr;
+  nblock->saddr += block_round(sizeof(dlu_arena));
+  nblock->abytes -= block_round(sizeof(dlu_arena));
+
+  arena->type = (priv) ? DLU_SMALL_BLOCK_PRIV : DLU_SMALL_BLOCK_SHARED;
+  arena->flags = flags;
+  arena->parent = parent;
+  set_arena(arena, nblock);
+
+  return arena;
+}
+
+void dlu_arena_bind(dlu_arena *arena) {
+  bound_arena = arena;
+}
+
+void *dlu_arena_alloc(dlu_arena *arena, size_t bytes) {
+  if (!arena) return NULL;
+  return arena_alloc(arena, bytes);
+}
+
+void dlu_arena_free(dlu_arena *arena, void *ptr) {
+  if (!arena) return;
+  arena_free(arena, ptr);
+}
+
+void *dlu_arena_realloc(dlu_arena *arena, void *ptr, size_t bytes) {
+  if (!arena) return NULL;
+  return arena_realloc(arena, ptr, bytes);
+}
+
+/**
+* An arena carved from a dlu_otma(3) block is given back to it.
+* An arena with its own mapping is unmapped.
+* Chunks chained after the first one are always unmapped.
+*/
+void dlu_arena_destroy(dlu_arena *arena) {
+  pthread_mutex_t *lock = NULL;
+
+  if (!arena) return;
+
+  if (bound_arena == arena) bound_arena = NULL;
+
+  dlu_mem_block_t *large_block = arena->large_block;
+  dlu_arena *parent = arena->parent;
+  arena->large_block = arena->chunk = arena->small_block = arena->sstart_addr = NULL;
+
+  if (parent) {
+    release_chunks(large_block->next);
+
+    get_global_arena(parent->type, &lock);
+    pthread_mutex_lock(lock);
+    arena_free(parent, large_block);
+    pthread_mutex_unlock(lock);
+    return;
+  }
+
+  release_chunks(large_block);
 }
 
 bool dlu_otma(dlu_block_type type, dlu_otma_mems ma) {
+  dlu_arena *arena = NULL;
+  pthread_mutex_t *lock = NULL;
+  void *saddr = NULL;
   size_t size = 0;
 
   if (type == DLU_SMALL_BLOCK_PRIV || type == DLU_SMALL_BLOCK_SHARED) {
@@ -254,150 +1146,207 @@ bool dlu_otma(dlu_block_type type, dlu_otma_mems ma) {
     return false;
   }
 
-  if (large_block_priv) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return false; }
-  if (large_block_shared) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return false; }
+  if (priv_arena.large_block) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return false; }
+  if (shared_arena.large_block) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return false; }
+
+  /* Exported memory can't hold block metadata */
+  if (type == DLU_LARGE_BLOCK_SHARED) ma.flags |= DLU_BLOCK_HEADERLESS;
 
   /* This allows for exact byte allocation. Resulting in no fragmented memory */
-  size += (ma.inta_cnt) ? (BLOCK_SIZE + (ma.inta_cnt * sizeof(int))) : 0;
-  size += (ma.cha_cnt ) ? (BLOCK_SIZE + (ma.cha_cnt  * sizeof(char))) : 0;
-  size += (ma.fla_cnt  ) ? (BLOCK_SIZE + (ma.fla_cnt   * sizeof(float))) : 0;
-  size += (ma.fla_cnt  ) ? (BLOCK_SIZE + (ma.dba_cnt  * sizeof(double))) : 0;
+  size += (ma.flags & DLU_BLOCK_HEADERLESS) ? BLOCK_ALIGN : BLOCK_SIZE; /* metadata of the first small block */
+  size += (ma.inta_cnt) ? block_cost(ma.flags, ma.inta_cnt * sizeof(int)) : 0;
+  size += (ma.cha_cnt ) ? block_cost(ma.flags, ma.cha_cnt * sizeof(char)) : 0;
+  size += (ma.fla_cnt  ) ? block_cost(ma.flags, ma.fla_cnt * sizeof(float)) : 0;
+  size += (ma.dba_cnt  ) ? block_cost(ma.flags, ma.dba_cnt * sizeof(double)) : 0;
+
+  size += (ma.vkcomp_cnt     ) ? block_cost(ma.flags, ma.vkcomp_cnt * sizeof(vkcomp)) : 0;
+  size += (ma.vkext_props_cnt) ? block_cost(ma.flags, ma.vkext_props_cnt * sizeof(VkExtensionProperties)) : 0;
+  size += (ma.vk_layer_cnt) ? block_cost(ma.flags, ma.vk_layer_cnt * sizeof(VkLayerProperties)) : 0;
+
+  size += (ma.si_cnt ) ? block_cost(ma.flags, ma.si_cnt * sizeof(struct _swap_chain_buffers)) : 0;
+  size += (ma.si_cnt ) ? block_cost(ma.flags, ma.si_cnt * sizeof(struct _synchronizers)) : 0;
+  size += (ma.scd_cnt) ? block_cost(ma.flags, ma.scd_cnt* sizeof(struct _sc_data)) : 0;
+
+  size += (ma.gp_cnt ) ? block_cost(ma.flags, ma.gp_cnt * sizeof(VkPipeline)) : 0;
+  size += (ma.gpd_cnt) ? block_cost(ma.flags, ma.gpd_cnt * sizeof(struct _gp_data)) : 0;
+
+  size += (ma.si_cnt  ) ? block_cost(ma.flags, ma.si_cnt * sizeof(VkCommandBuffer)) : 0;
+  size += (ma.si_cnt  ) ? block_cost(ma.flags, ma.si_cnt * sizeof(uint64_t)) : 0;
+  size += (ma.cmdd_cnt) ? block_cost(ma.flags, ma.cmdd_cnt * sizeof(struct _cmd_data)) : 0;
+
+  size += (ma.bd_cnt) ? block_cost(ma.flags, ma.bd_cnt * sizeof(struct _buff_data)) : 0;
 
-  size += (ma.vkcomp_cnt     ) ? (BLOCK_SIZE + (ma.vkcomp_cnt * sizeof(vkcomp))) : 0;
-  size += (ma.vkext_props_cnt) ? (BLOCK_SIZE + (ma.vkext_props_cnt * sizeof(VkExtensionProperties))) : 0;
-  size += (ma.vk_layer_cnt) ? (BLOCK_SIZE + (ma.vk_layer_cnt * sizeof(VkLayerProperties))) : 0;
+  size += (ma.desc_cnt) ? block_cost(ma.flags, ma.desc_cnt * sizeof(VkDescriptorSet)) : 0;
+  size += (ma.desc_cnt) ? block_cost(ma.flags, ma.desc_cnt * sizeof(VkDescriptorSetLayout)) : 0;
+  size += (ma.dd_cnt  ) ? block_cost(ma.flags, ma.dd_cnt * sizeof(struct _desc_data)) : 0;
 
-  size += (ma.si_cnt ) ? (BLOCK_SIZE + (ma.si_cnt * sizeof(struct _swap_chain_buffers))) : 0;
-  size += (ma.si_cnt ) ? (BLOCK_SIZE + (ma.si_cnt * sizeof(struct _synchronizers))) : 0;
-  size += (ma.scd_cnt) ? (BLOCK_SIZE + (ma.scd_cnt* sizeof(struct _sc_data))) : 0;
+  size += (ma.td_cnt ) ? block_cost(ma.flags, ma.td_cnt * sizeof(struct _text_data)) : 0;
 
-  size += (ma.gp_cnt ) ? (BLOCK_SIZE + (ma.gp_cnt * sizeof(VkPipeline))) : 0;
-  size += (ma.gpd_cnt) ? (BLOCK_SIZE + (ma.gpd_cnt * sizeof(struct _gp_data))) : 0;
+  size += (ma.pd_cnt) ? block_cost(ma.flags, ma.pd_cnt * sizeof(struct _pd_data)) : 0;
+  size += (ma.ld_cnt) ? block_cost(ma.flags, ma.ld_cnt * sizeof(struct _ld_data)) : 0;
 
-  size += (ma.si_cnt  ) ? (BLOCK_SIZE + (ma.si_cnt * sizeof(VkCommandBuffer))) : 0;
-  size += (ma.cmdd_cnt) ? (BLOCK_SIZE + (ma.cmdd_cnt * sizeof(struct _cmd_data))) : 0;
+  size += (ma.drmc_cnt) ? block_cost(ma.flags, ma.drmc_cnt * sizeof(dlu_drm_core)) : 0;
+  size += (ma.dod_cnt ) ? block_cost(ma.flags, ma.dod_cnt * sizeof(struct _output_data)) : 0;
 
-  size += (ma.bd_cnt) ? (BLOCK_SIZE + (ma.bd_cnt * sizeof(struct _buff_data))) : 0;
+  size += (ma.dob_cnt) ? block_cost(ma.flags, ma.dob_cnt * sizeof(struct _drm_buff_data)) : 0;
 
-  size += (ma.desc_cnt) ? (BLOCK_SIZE + (ma.desc_cnt * sizeof(VkDescriptorSet))) : 0;
-  size += (ma.desc_cnt) ? (BLOCK_SIZE + (ma.desc_cnt * sizeof(VkDescriptorSetLayout))) : 0;
-  size += (ma.dd_cnt  ) ? (BLOCK_SIZE + (ma.dd_cnt * sizeof(struct _desc_data))) : 0;
+  size += (ma.ala_cnt) ? ma.ala_cnt * align_cost(ma.flags, ma.ala_bytes, ma.ala_align) : 0;
 
-  size += (ma.td_cnt ) ? (BLOCK_SIZE + (ma.td_cnt * sizeof(struct _text_data))) : 0;
+  arena = get_global_arena(type, &lock);
+  pthread_mutex_lock(lock);
+  saddr = set_global_block(arena, type, size, ma.flags);
+  pthread_mutex_unlock(lock);
 
-  size += (ma.pd_cnt) ? (BLOCK_SIZE + (ma.pd_cnt * sizeof(struct _pd_data))) : 0;
-  size += (ma.ld_cnt) ? (BLOCK_SIZE + (ma.ld_cnt * sizeof(struct _ld_data))) : 0;
+  return (saddr) ? true : false;
+}
 
-  size += (ma.drmc_cnt) ? (BLOCK_SIZE + (ma.drmc_cnt * sizeof(dlu_drm_core))) : 0;
-  size += (ma.dod_cnt ) ? (BLOCK_SIZE + (ma.dod_cnt * sizeof(struct _output_data))) : 0;
 
-  size += (ma.dob_cnt) ? (BLOCK_SIZE + (ma.dob_cnt * sizeof(struct _drm_buff_data))) : 0;
+/* Bytes a small block of arena can hold, its size class for header-less blocks */
+static size_t block_bytes(dlu_arena *arena, void *ptr) {
+  if (arena->flags & DLU_BLOCK_HEADERLESS) {
+    uint8_t *entry = hl_entry(arena, ptr);
+    return (entry) ? bin_size(*entry - 1) : 0;
+  }
 
-  if (!dlu_alloc(type, size)) return false;
+  return ((dlu_mem_block_t *) (ptr - BLOCK_SIZE))->size;
+}
+
+/**
+* dlu_otba(3) arrays always live in the global private arena. An arena bound to the
+* calling thread must never see them, it would file their blocks in its own free lists.
+*/
+static void *otba_realloc(void *ptr, size_t bytes) {
+  pthread_mutex_lock(&priv_lock);
+  size_t old = (ptr) ? block_bytes(&priv_arena, ptr) : 0;
+  void *nptr = arena_realloc(&priv_arena, ptr, bytes);
+
+  /**
+  * Count what the array holds now, not every size it had. Unsigned wrap takes care
+  * of shrinking. Other threads may be allocating for the same type.
+  */
+  if (nptr && otba_type != NEG_ONE)
+    __atomic_fetch_add(&otba_bytes[otba_type], block_bytes(&priv_arena, nptr) - old, __ATOMIC_RELAXED);
+
+  pthread_mutex_unlock(&priv_lock);
+  return nptr;
+}
+
+/**
+* Arrays allocated by dlu_otba(3) grow when asked for more elements than they hold.
+* Capacity at least doubles so repeated growth stays amortized O(1). Elements keep
+* their index, but the array may move so don't hold pointers to elements across calls.
+* Returns the old capacity (index of the first new element) through first.
+*/
+static bool grow_array(void **arr, uint32_t *cnt, uint32_t arr_size, size_t esize, uint32_t *first) {
+  void *narr = NULL;
+
+  *first = (*arr) ? *cnt : 0;
+  if (*arr && arr_size <= *cnt) return true;
+  if (*arr && arr_size < (*cnt << 1)) arr_size = *cnt << 1;
+
+  narr = otba_realloc(*arr, arr_size * esize);
+  if (!narr) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+
+  *arr = narr;
+  *cnt = arr_size;
 
   return true;
 }
 
-bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size) {
+static bool otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size) {
+  uint32_t first = 0;
+
   switch (type) {
     case DLU_SC_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->sc_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _sc_data));
-        if (!app->sc_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->sc_data, &app->sdc, arr_size, sizeof(struct _sc_data), &first)) return false;
 
         /* Populate ldi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
+        for (uint32_t i = first; i < app->sdc; i++)
           app->sc_data[i].ldi = UINT32_MAX;
 
-        app->sdc = arr_size; return true;
+        return true;
       }
     case DLU_GP_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->gp_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _gp_data));
-        if (!app->gp_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->gp_data, &app->gdc, arr_size, sizeof(struct _gp_data), &first)) return false;
 
         /* Populate ldi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
+        for (uint32_t i = first; i < app->gdc; i++)
           app->gp_data[i].ldi = UINT32_MAX;
 
-        app->gdc = arr_size; return true;
+        return true;
       }
     case DLU_CMD_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->cmd_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _cmd_data));
-        if (!app->cmd_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->cmd_data, &app->cdc, arr_size, sizeof(struct _cmd_data), &first)) return false;
 
         /* Populate ldi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
+        for (uint32_t i = first; i < app->cdc; i++)
           app->cmd_data[i].ldi = UINT32_MAX;
 
-        app->cdc = arr_size; return true;
+        return true;
       }
     case DLU_BUFF_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->buff_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _buff_data));
-        if (!app->buff_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->buff_data, &app->bdc, arr_size, sizeof(struct _buff_data), &first)) return false;
 
         /* Populate ldi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
+        for (uint32_t i = first; i < app->bdc; i++)
           app->buff_data[i].ldi = UINT32_MAX;
 
-        app->bdc = arr_size; return true;
+        return true;
       }
     case DLU_DESC_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->desc_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _desc_data));
-        if (!app->desc_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->desc_data, &app->ddc, arr_size, sizeof(struct _desc_data), &first)) return false;
 
         /* Populate ldi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
-          app->gp_data[i].ldi = UINT32_MAX;
+        for (uint32_t i = first; i < app->ddc; i++)
+          app->desc_data[i].ldi = UINT32_MAX;
 
-        app->ddc = arr_size; return true;
+        return true;
       }
     case DLU_TEXT_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->text_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _text_data));
-        if (!app->text_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->text_data, &app->tdc, arr_size, sizeof(struct _text_data), &first)) return false;
 
         /* Populate ldi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
-          app->gp_data[i].ldi = UINT32_MAX;
+        for (uint32_t i = first; i < app->tdc; i++)
+          app->text_data[i].ldi = UINT32_MAX;
 
-        app->tdc = arr_size; return true;
+        return true;
       }
     case DLU_PD_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->pd_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _pd_data));
-        if (!app->pd_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->pd_data, &app->pdc, arr_size, sizeof(struct _pd_data), &first)) return false;
 
         /* need for dlu_create_queue_families(3) */
-        for (uint32_t i = 0; i < arr_size; i++) {
+        for (uint32_t i = first; i < app->pdc; i++) {
           app->pd_data[i].gfam_idx = UINT32_MAX;
           app->pd_data[i].cfam_idx = UINT32_MAX;
           app->pd_data[i].tfam_idx = UINT32_MAX;
         }
 
-        app->pdc = arr_size; return true;
+        return true;
       }
     case DLU_LD_DATA:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->ld_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _ld_data));
-        if (!app->ld_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &app->ld_data, &app->ldc, arr_size, sizeof(struct _ld_data), &first)) return false;
 
         /* Populate pdi for error checking */
-        for (uint32_t i = 0; i < arr_size; i++)
+        for (uint32_t i = first; i < app->ldc; i++)
           app->ld_data[i].pdi = UINT32_MAX;
 
-        app->ldc = arr_size; return true;
+        return true;
       }
     case DLU_SC_DATA_MEMS:
       {
@@ -409,16 +1358,26 @@ bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size)
         */
         arr_size += 1;
 
+        /**
+        * Arrays are resized when they already exist. So a swap chain recreated
+        * after dlu_freeup_sc(3) reuses the same memory (and synchronizers)
+        */
+
         /* Allocate SwapChain Buffers (VkImage, VkImageView, VkFramebuffer) */
-        app->sc_data[index].sc_buffs = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _swap_chain_buffers));
+        app->sc_data[index].sc_buffs = otba_realloc(app->sc_data[index].sc_buffs, arr_size * sizeof(struct _swap_chain_buffers));
         if (!app->sc_data[index].sc_buffs) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
 
         /* Allocate CommandBuffers */
-        app->cmd_data[index].cmd_buffs = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(VkCommandBuffer));
+        app->cmd_data[index].cmd_buffs = otba_realloc(app->cmd_data[index].cmd_buffs, arr_size * sizeof(VkCommandBuffer));
         if (!app->cmd_data[index].cmd_buffs) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
 
+        /* Cached command buffers were recorded against the old framebuffers */
+        app->cmd_data[index].recorded = otba_realloc(app->cmd_data[index].recorded, arr_size * sizeof(uint64_t));
+        if (!app->cmd_data[index].recorded) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        memset(app->cmd_data[index].recorded, 0, arr_size * sizeof(uint64_t));
+
         /* Allocate Semaphores */
-        app->sc_data[index].syncs = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _synchronizers));
+        app->sc_data[index].syncs = otba_realloc(app->sc_data[index].syncs, arr_size * sizeof(struct _synchronizers));
         if (!app->sc_data[index].syncs) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
         app->sc_data[index].sic = arr_size; return true;
       }
@@ -426,10 +1385,10 @@ bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size)
       {
         vkcomp *app = (vkcomp *) addr;
 
-        app->desc_data[index].layouts = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(VkDescriptorSetLayout));
+        app->desc_data[index].layouts = otba_realloc(app->desc_data[index].layouts, arr_size * sizeof(VkDescriptorSetLayout));
         if (!app->desc_data[index].layouts) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
 
-        app->desc_data[index].desc_set = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(VkDescriptorSet));
+        app->desc_data[index].desc_set = otba_realloc(app->desc_data[index].desc_set, arr_size * sizeof(VkDescriptorSet));
         if (!app->desc_data[index].desc_set) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
 
         app->desc_data[index].dlsc = arr_size; return true;
@@ -437,31 +1396,28 @@ bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size)
     case DLU_GP_DATA_MEMS:
       {
         vkcomp *app = (vkcomp *) addr;
-        app->gp_data[index].graphics_pipelines = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(VkPipeline));
+        app->gp_data[index].graphics_pipelines = otba_realloc(app->gp_data[index].graphics_pipelines, arr_size * sizeof(VkPipeline));
         if (!app->gp_data[index].graphics_pipelines) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
         app->gp_data[index].gpc = arr_size; return true;
       }
     case DLU_DEVICE_OUTPUT_DATA:
       {
         dlu_drm_core *core = (dlu_drm_core *) addr;
-        core->output_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _output_data));
-        if (!core->output_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
-        core->odc = arr_size; return true;
+        return grow_array((void **) &core->output_data, &core->odc, arr_size, sizeof(struct _output_data), &first);
       }
     case DLU_DEVICE_OUTPUT_BUFF_DATA:
       {
         dlu_drm_core *core = (dlu_drm_core *) addr;
-        core->buff_data = dlu_alloc(DLU_SMALL_BLOCK_PRIV, arr_size * sizeof(struct _drm_buff_data));
-        if (!core->buff_data) { PERR(DLU_ALLOC_FAILED, 0, NULL); return false; }
+        if (!grow_array((void **) &core->buff_data, &core->odbc, arr_size, sizeof(struct _drm_buff_data), &first)) return false;
 
-        for (uint32_t i = 0; i < arr_size; i++) {
+        for (uint32_t i = first; i < core->odbc; i++) {
           core->buff_data[i].fb_id = UINT32_MAX;
           core->buff_data[i].odid = UINT32_MAX;
           for (uint32_t j = 0; j < 4; j++)
             core->buff_data[i].dma_buf_fds[j] = NEG_ONE;
         }
 
-        core->odbc = arr_size; return true;
+        return true;
       }
     default: break;
   }
@@ -470,33 +1426,214 @@ bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size)
   return false;
 }
 
+/* Arrays grown while otba_type is set are counted towards the type */
+bool dlu_otba(dlu_data_type type, void *addr, uint32_t index, uint32_t arr_size) {
+  otba_type = otba_index(type);
+  bool ret = otba(type, addr, index, arr_size);
+  otba_type = NEG_ONE;
+  return ret;
+}
+
+bool dlu_get_mem_stats(dlu_block_type type, dlu_mem_stats *stats) {
+  pthread_mutex_t *lock = NULL;
+
+  dlu_arena *arena = get_global_arena(type, &lock);
+  if (!arena || !stats) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); return false; }
+
+  memset(stats, 0, sizeof(dlu_mem_stats));
+
+  pthread_mutex_lock(lock);
+  if (arena->large_block) {
+    stats->reserved = arena->reserved;
+    stats->used = arena->consumed - arena->released;
+    stats->free = arena->chunk->abytes + arena->released;
+    stats->peak = arena->peak;
+    stats->alloc_cnt = arena->alloc_cnt;
+    stats->free_cnt = arena->free_cnt;
+  }
+  pthread_mutex_unlock(lock);
+
+  for (uint32_t i = 0; i < DLU_OTBA_TYPE_CNT; i++)
+    stats->otba_bytes[i] = __atomic_load_n(&otba_bytes[i], __ATOMIC_RELAXED);
+
+  return true;
+}
+
+void dlu_print_mem_stats(dlu_block_type type) {
+  static const char *names[DLU_OTBA_TYPE_CNT] = {
+    "DLU_SC_DATA", "DLU_GP_DATA", "DLU_CMD_DATA", "DLU_BUFF_DATA", "DLU_DESC_DATA",
+    "DLU_TEXT_DATA", "DLU_PD_DATA", "DLU_LD_DATA", "DLU_SC_DATA_MEMS", "DLU_DESC_DATA_MEMS",
+    "DLU_GP_DATA_MEMS", "DLU_DEVICE_OUTPUT_DATA", "DLU_DEVICE_OUTPUT_BUFF_DATA"
+  };
+
+  dlu_mem_stats stats;
+  if (!dlu_get_mem_stats(type, &stats)) return;
+
+  dlu_print_msg(DLU_SUCCESS, "\n  %s block\n", (type & (DLU_LARGE_BLOCK_SHARED | DLU_SMALL_BLOCK_SHARED)) ? "Shared" : "Private");
+  dlu_print_msg(DLU_INFO, "\tReserved: %zu bytes\n", stats.reserved);
+  dlu_print_msg(DLU_INFO, "\tUsed: %zu bytes (peak %zu bytes)\n", stats.used, stats.peak);
+  dlu_print_msg(DLU_INFO, "\tFree: %zu bytes\n", stats.free);
+  dlu_print_msg(DLU_INFO, "\tAllocations: %lu, Releases: %lu\n", stats.alloc_cnt, stats.free_cnt);
+
+  for (uint32_t i = 0; i < DLU_OTBA_TYPE_CNT; i++)
+    if (stats.otba_bytes[i])
+      dlu_print_msg(DLU_INFO, "\t%s: %zu bytes\n", names[i], stats.otba_bytes[i]);
+}
+
 /**
 * Releasing memory in this case means to
 * unmap all virtual pages (remove page tables)
 */
 void dlu_release_blocks() {
-  if (large_block_priv) {
-    if (munmap(large_block_priv, BLOCK_SIZE + large_block_priv->size) == NEG_ONE) {
-      dlu_log_me(DLU_DANGER, "[x] munmap: %s", strerror(errno));
+  for (uint32_t i = 0; i < DLU_OTBA_TYPE_CNT; i++)
+    __atomic_store_n(&otba_bytes[i], 0, __ATOMIC_RELAXED);
+
+  pthread_mutex_lock(&priv_lock);
+  if (priv_arena.large_block) {
+    if (!release_chunks(priv_arena.large_block)) {
+      pthread_mutex_unlock(&priv_lock);
       return;
     }
-    large_block_priv = NULL;
+    priv_arena.large_block = priv_arena.chunk = NULL;
   }
+  priv_arena.flags = 0;
+  pthread_mutex_unlock(&priv_lock);
 
-  if (large_block_shared) {
-    if (munmap(large_block_shared, BLOCK_SIZE + large_block_shared->size) == NEG_ONE) {
-      dlu_log_me(DLU_DANGER, "[x] munmap: %s", strerror(errno));
+  pthread_mutex_lock(&shared_lock);
+  if (shared_arena.large_block) {
+    if (!release_chunks(shared_arena.large_block)) {
+      pthread_mutex_unlock(&shared_lock);
       return;
     }
-    large_block_shared = NULL;
+    shared_arena.large_block = shared_arena.chunk = NULL;
+  }
+  shared_arena.flags = 0;
+
+  if (shared_fd != NEG_ONE) {
+    if (close(shared_fd) == NEG_ONE)
+      dlu_log_me(DLU_DANGER, "[x] close: %s", strerror(errno));
+    shared_fd = NEG_ONE;
+  }
+  pthread_mutex_unlock(&shared_lock);
+}
+
+bool dlu_export_shared_block(int sock) {
+  char data = 0, cbuf[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = { .iov_base = &data, .iov_len = sizeof(data) };
+  struct msghdr msg = {};
+  struct cmsghdr *cmsg = NULL;
+  bool ret = false;
+
+  memset(cbuf, 0, sizeof(cbuf));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cbuf;
+  msg.msg_controllen = sizeof(cbuf);
+
+  pthread_mutex_lock(&shared_lock);
+  if (shared_fd == NEG_ONE) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); goto finish_export; }
+
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &shared_fd, sizeof(int));
+
+  if (sendmsg(sock, &msg, 0) == NEG_ONE) {
+    dlu_log_me(DLU_DANGER, "[x] sendmsg: %s", strerror(errno));
+    goto finish_export;
   }
+
+  ret = true;
+finish_export:
+  pthread_mutex_unlock(&shared_lock);
+  return ret;
+}
+
+void *dlu_import_shared_block(int sock, size_t *bytes) {
+  char data = 0, cbuf[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = { .iov_base = &data, .iov_len = sizeof(data) };
+  struct msghdr msg = {};
+  struct cmsghdr *cmsg = NULL;
+  struct stat st;
+  void *addr = NULL;
+  int fd = NEG_ONE;
+
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cbuf;
+  msg.msg_controllen = sizeof(cbuf);
+
+  if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) == NEG_ONE) {
+    dlu_log_me(DLU_DANGER, "[x] recvmsg: %s", strerror(errno));
+    return NULL;
+  }
+
+  cmsg = CMSG_FIRSTHDR(&msg);
+  if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+    dlu_log_me(DLU_DANGER, "[x] recvmsg: no file descriptor was received");
+    return NULL;
+  }
+
+  memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+  /* Size is sealed by the exporting process */
+  if (fstat(fd, &st) == NEG_ONE) {
+    dlu_log_me(DLU_DANGER, "[x] fstat: %s", strerror(errno));
+    goto finish_import;
+  }
+
+  addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    dlu_log_me(DLU_DANGER, "[x] mmap: %s", strerror(errno));
+    addr = NULL;
+    goto finish_import;
+  }
+
+  *bytes = st.st_size;
+
+finish_import:
+  if (close(fd) == NEG_ONE)
+    dlu_log_me(DLU_DANGER, "[x] close: %s", strerror(errno));
+  return addr;
+}
+
+void dlu_detach_shared_block(void *addr, size_t bytes) {
+  if (!addr) return;
+
+  if (munmap(addr, bytes) == NEG_ONE)
+    dlu_log_me(DLU_DANGER, "[x] munmap: %s", strerror(errno));
+}
+
+size_t dlu_shared_offset(void *ptr) {
+  return ptr - shared_arena.large_block->saddr;
+}
+
+void *dlu_shared_ptr(void *addr, size_t offset) {
+  return addr + offset;
 }
 
 /* This is an INAPI_CALL */
 void dlu_print_mb(dlu_block_type type) {
-  dlu_mem_block_t *current = (type == DLU_SMALL_BLOCK_SHARED) ? sstart_addr_shared : sstart_addr_priv;
+  dlu_arena *arena = (type == DLU_SMALL_BLOCK_SHARED) ? &shared_arena : &priv_arena;
+
+  /* Header-less blocks are described by the side table of each chunk */
+  if (arena->flags & DLU_BLOCK_HEADERLESS) {
+    for (dlu_mem_block_t *chunk = arena->large_block; chunk; chunk = chunk->next) {
+      uint8_t *table = chunk->prv_addr;
+      size_t granules = (chunk->prv_addr - chunk->saddr) / BLOCK_ALIGN;
+      for (size_t i = 0; i < granules; i++) {
+        if (!table[i]) continue;
+        dlu_log_me(DLU_INFO, "chunk = %p, block = %p, block size = %zu, released = %d", chunk,
+                              chunk->saddr + (i * BLOCK_ALIGN), bin_size((table[i] & ~HL_RELEASED) - 1), table[i] & HL_RELEASED);
+      }
+    }
+    return;
+  }
+
+  dlu_mem_block_t *current = arena->sstart_addr;
   while (current->next) {
-    dlu_log_me(DLU_INFO, "current block = %p, next block = %p, block size = %d, saddr = %p",
+    dlu_log_me(DLU_INFO, "current block = %p, next block = %p, block size = %zu, saddr = %p",
                           current, current->next, current->size, current->saddr);
     current = current->next;
   }
@@ -0,0 +1,253 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+#include <pthread.h>
+
+/* Arena carving needs a header in front of every allocation to know where it came from */
+#define BASE_ALIGN 16
+
+/**
+* Struct placed right before every pointer handed to the driver
+* base  | Address returned by malloc or the arena
+* size  | Bytes requested by the driver
+* scope | VkSystemAllocationScope it was made with
+* arena | Whether base came from the dedicated arena
+*/
+typedef struct _alloc_hdr {
+  void *base;
+  size_t size;
+  uint32_t scope;
+  bool arena;
+} alloc_hdr;
+
+/* Header space in front of a pointer, keeps base + HDR_SIZE BASE_ALIGN aligned */
+#define HDR_SIZE ((sizeof(alloc_hdr) + (BASE_ALIGN - 1)) & ~((size_t) BASE_ALIGN - 1))
+
+/**
+* Host allocation tracker. The callbacks are its first member so app->vk_alloc
+* is all vkcomp needs to keep. The driver may call from any thread, so every
+* callback goes through the lock. The arena itself is single threaded.
+*/
+typedef struct _dlu_vk_host_alloc {
+  VkAllocationCallbacks cbs;
+  pthread_mutex_t lock;
+  dlu_arena *arena;
+  size_t limit;
+  size_t used;
+  dlu_vk_host_alloc_stats stats[DLU_VK_ALLOC_SCOPE_CNT];
+} dlu_vk_host_alloc;
+
+/* Command and object scope allocations come and go with command buffers and objects */
+static bool arena_scope(VkSystemAllocationScope scope) {
+  return scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND || scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+}
+
+static void *host_alloc(void *data, size_t size, size_t align, VkSystemAllocationScope scope) {
+  dlu_vk_host_alloc *ha = (dlu_vk_host_alloc *) data;
+  void *base = NULL, *ptr = NULL;
+  bool arena = false;
+
+  if (!size || (uint32_t) scope >= DLU_VK_ALLOC_SCOPE_CNT) return NULL;
+  if (align < BASE_ALIGN) align = BASE_ALIGN;
+
+  /* Both malloc and the arena return BASE_ALIGN aligned addresses, worst case padding is align - BASE_ALIGN */
+  size_t bytes = HDR_SIZE + (align - BASE_ALIGN) + size;
+
+  pthread_mutex_lock(&ha->lock);
+
+  if (ha->limit && (ha->used + size) > ha->limit) {
+    ha->stats[scope].fail_cnt++;
+    pthread_mutex_unlock(&ha->lock);
+    dlu_log_me(DLU_WARNING, "Driver host allocation of %zu bytes refused, %zu of %zu bytes in use", size, ha->used, ha->limit);
+    return NULL;
+  }
+
+  if (ha->arena && arena_scope(scope)) {
+    base = dlu_arena_alloc(ha->arena, bytes);
+    arena = (base != NULL);
+  }
+
+  if (!base) base = malloc(bytes);
+  if (!base) { ha->stats[scope].fail_cnt++; pthread_mutex_unlock(&ha->lock); return NULL; }
+
+  ptr = (void *) (((uintptr_t) base + HDR_SIZE + (align - 1)) & ~((uintptr_t) align - 1));
+
+  alloc_hdr *hdr = (alloc_hdr *) ptr - 1;
+  hdr->base = base;
+  hdr->size = size;
+  hdr->scope = scope;
+  hdr->arena = arena;
+
+  ha->used += size;
+  ha->stats[scope].used += size;
+  if (ha->stats[scope].used > ha->stats[scope].peak) ha->stats[scope].peak = ha->stats[scope].used;
+  ha->stats[scope].alloc_cnt++;
+  if (arena) ha->stats[scope].arena_cnt++;
+
+  pthread_mutex_unlock(&ha->lock);
+
+  return ptr;
+}
+
+static void host_free(void *data, void *ptr) {
+  dlu_vk_host_alloc *ha = (dlu_vk_host_alloc *) data;
+
+  if (!ptr) return;
+
+  alloc_hdr *hdr = (alloc_hdr *) ptr - 1;
+
+  pthread_mutex_lock(&ha->lock);
+
+  ha->used -= hdr->size;
+  ha->stats[hdr->scope].used -= hdr->size;
+  ha->stats[hdr->scope].free_cnt++;
+
+  if (hdr->arena) dlu_arena_free(ha->arena, hdr->base);
+  else free(hdr->base);
+
+  pthread_mutex_unlock(&ha->lock);
+}
+
+/* Alignment of a reallocation is the one the original was made with */
+static void *host_realloc(void *data, void *orig, size_t size, size_t align, VkSystemAllocationScope scope) {
+  if (!orig) return host_alloc(data, size, align, scope);
+  if (!size) { host_free(data, orig); return NULL; }
+
+  void *ptr = host_alloc(data, size, align, scope);
+  if (!ptr) return NULL;
+
+  size_t old_size = ((alloc_hdr *) orig - 1)->size;
+  memcpy(ptr, orig, (old_size < size) ? old_size : size);
+  host_free(data, orig);
+
+  return ptr;
+}
+
+static void host_internal_alloc(void *data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) {
+  dlu_vk_host_alloc *ha = (dlu_vk_host_alloc *) data;
+  (void) type;
+
+  if ((uint32_t) scope >= DLU_VK_ALLOC_SCOPE_CNT) return;
+
+  pthread_mutex_lock(&ha->lock);
+  ha->stats[scope].internal += size;
+  pthread_mutex_unlock(&ha->lock);
+}
+
+static void host_internal_free(void *data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) {
+  dlu_vk_host_alloc *ha = (dlu_vk_host_alloc *) data;
+  (void) type;
+
+  if ((uint32_t) scope >= DLU_VK_ALLOC_SCOPE_CNT) return;
+
+  pthread_mutex_lock(&ha->lock);
+  ha->stats[scope].internal -= size;
+  pthread_mutex_unlock(&ha->lock);
+}
+
+VkResult dlu_vk_host_alloc_create(vkcomp *app, size_t arena_size, size_t limit) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_host_alloc *ha = NULL;
+
+  /* Objects must be destroyed with callbacks compatible with the ones they were created with */
+  if (app->instance || app->vk_alloc) {
+    dlu_log_me(DLU_DANGER, "[x] dlu_vk_host_alloc_create must be called once, before dlu_create_instance");
+    return res;
+  }
+
+  ha = calloc(1, sizeof(dlu_vk_host_alloc));
+  if (!ha) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+
+  if (pthread_mutex_init(&ha->lock, NULL)) {
+    dlu_log_me(DLU_DANGER, "[x] pthread_mutex_init failed");
+    free(ha); return res;
+  }
+
+  if (arena_size) {
+    ha->arena = dlu_arena_create(DLU_LARGE_BLOCK_PRIV, arena_size);
+    if (!ha->arena) {
+      pthread_mutex_destroy(&ha->lock);
+      free(ha); return res;
+    }
+  }
+
+  ha->limit = limit;
+  ha->cbs.pUserData = ha;
+  ha->cbs.pfnAllocation = host_alloc;
+  ha->cbs.pfnReallocation = host_realloc;
+  ha->cbs.pfnFree = host_free;
+  ha->cbs.pfnInternalAllocation = host_internal_alloc;
+  ha->cbs.pfnInternalFree = host_internal_free;
+
+  app->vk_alloc = &ha->cbs;
+
+  return VK_SUCCESS;
+}
+
+bool dlu_vk_host_alloc_get_stats(vkcomp *app, VkSystemAllocationScope scope, dlu_vk_host_alloc_stats *stats) {
+  if (!app->vk_alloc || (uint32_t) scope >= DLU_VK_ALLOC_SCOPE_CNT) return false;
+
+  dlu_vk_host_alloc *ha = (dlu_vk_host_alloc *) app->vk_alloc->pUserData;
+
+  pthread_mutex_lock(&ha->lock);
+  *stats = ha->stats[scope];
+  pthread_mutex_unlock(&ha->lock);
+
+  return true;
+}
+
+void dlu_vk_host_alloc_print_stats(vkcomp *app) {
+  static const char *names[DLU_VK_ALLOC_SCOPE_CNT] = {
+    "COMMAND", "OBJECT", "CACHE", "DEVICE", "INSTANCE"
+  };
+
+  dlu_vk_host_alloc_stats stats;
+
+  dlu_print_msg(DLU_SUCCESS, "\n  Driver host allocations\n");
+  for (uint32_t i = 0; i < DLU_VK_ALLOC_SCOPE_CNT; i++) {
+    if (!dlu_vk_host_alloc_get_stats(app, (VkSystemAllocationScope) i, &stats)) return;
+    if (!stats.alloc_cnt && !stats.internal) continue;
+    dlu_print_msg(DLU_INFO, "\t%s: %zu bytes (peak %zu bytes), internal %zu bytes\n", names[i], stats.used, stats.peak, stats.internal);
+    dlu_print_msg(DLU_INFO, "\t\tAllocations: %lu (%lu from arena), Releases: %lu, Failed: %lu\n",
+                  stats.alloc_cnt, stats.arena_cnt, stats.free_cnt, stats.fail_cnt);
+  }
+}
+
+void dlu_vk_host_alloc_destroy(vkcomp *app) {
+  if (!app->vk_alloc) return;
+
+  dlu_vk_host_alloc *ha = (dlu_vk_host_alloc *) app->vk_alloc->pUserData;
+
+  if (ha->used) dlu_log_me(DLU_WARNING, "Driver still holds %zu bytes of host memory", ha->used);
+
+  /* Arena allocations still held by the driver go away with the arena */
+  dlu_arena_destroy(ha->arena);
+  pthread_mutex_destroy(&ha->lock);
+  free(ha);
+
+  app->vk_alloc = NULL;
+}
@@ -0,0 +1,326 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+/**
+* layout     | Layout of the table's set, created with the update after bind pool flag
+* pool       | Holds only the table's set
+* set        | The table, binding 0 is an array of capacity combined image samplers
+* stages     | Shader stages that index the table and read the push constants
+* capacity   | Amount of slots
+* next       | Slots below next were handed out at least once
+* free_cnt   | Amount of slots in free_slots
+* free_slots | Stack of slots given back by dlu_vk_bindless_remove(3), stored after the struct
+* textures   | Texture each slot points at, stored after free_slots
+* used       | Bitmap of slots currently handed out, stored after textures
+* fallback   | Texture slots of evicted textures are pointed at, UINT32_MAX if there's none
+* fb_layout  | Layout fallback is sampled in
+*/
+struct _dlu_vk_bindless {
+  VkDescriptorSetLayout layout;
+  VkDescriptorPool pool;
+  VkDescriptorSet set;
+  VkShaderStageFlags stages;
+  uint32_t capacity;
+  uint32_t next;
+  uint32_t free_cnt;
+  uint32_t *free_slots;
+  uint32_t *textures;
+  uint64_t *used;
+  uint32_t fallback;
+  VkImageLayout fb_layout;
+};
+
+#define SLOT_USED(bl, slot) ((bl)->used[(slot) >> 6] & (UINT64_C(1) << ((slot) & 63)))
+
+VkResult dlu_vk_bindless_create(vkcomp *app, uint32_t cur_ld, uint32_t capacity, VkShaderStageFlags stages) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = app->ld_data[cur_ld].device;
+  dlu_vk_bindless *bl = NULL;
+
+  if (!device) { PERR(DLU_VKCOMP_DEVICE, 0, NULL); return res; }
+  if (app->ld_data[cur_ld].bindless) { dlu_log_me(DLU_DANGER, "[x] Logical device %u already has a bindless table", cur_ld); return res; }
+  if (!capacity) { dlu_log_me(DLU_DANGER, "[x] A bindless table needs at least one slot"); return res; }
+  if (!app->get_props2) {
+    dlu_log_me(DLU_DANGER, "[x] Logical device %u wasn't created with %s", cur_ld, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    return res;
+  }
+
+  VkPhysicalDeviceDescriptorIndexingProperties indexing_props = {};
+  indexing_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+  indexing_props.pNext = NULL;
+
+  VkPhysicalDeviceProperties2 props2 = {};
+  props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  props2.pNext = &indexing_props;
+
+  app->get_props2(app->pd_data[app->ld_data[cur_ld].pdi].phys_dev, &props2);
+
+  /* Every slot is a combined image sampler, it counts against both the sampler and sampled image limits */
+  uint32_t limit = indexing_props.maxDescriptorSetUpdateAfterBindSampledImages;
+  if (indexing_props.maxDescriptorSetUpdateAfterBindSamplers < limit) limit = indexing_props.maxDescriptorSetUpdateAfterBindSamplers;
+  if (indexing_props.maxPerStageDescriptorUpdateAfterBindSampledImages < limit) limit = indexing_props.maxPerStageDescriptorUpdateAfterBindSampledImages;
+  if (indexing_props.maxPerStageDescriptorUpdateAfterBindSamplers < limit) limit = indexing_props.maxPerStageDescriptorUpdateAfterBindSamplers;
+
+  if (capacity > limit) {
+    dlu_log_me(DLU_DANGER, "[x] Bindless table of %u slots exceeds the update after bind sampler limit of logical device %u (%u)", capacity, cur_ld, limit);
+    return res;
+  }
+
+  /* free_slots and textures are padded to keep the bitmap 8 byte aligned */
+  size_t slots_size = ((2 * capacity * sizeof(uint32_t)) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+  bl = calloc(1, sizeof(dlu_vk_bindless) + slots_size + (((capacity + 63) >> 6) * sizeof(uint64_t)));
+  if (!bl) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+
+  bl->free_slots = (uint32_t *) (bl + 1);
+  bl->textures = bl->free_slots + capacity;
+  bl->used = (uint64_t *) ((char *) bl->free_slots + slots_size);
+  bl->fallback = UINT32_MAX;
+  bl->capacity = capacity;
+  bl->stages = stages;
+  app->ld_data[cur_ld].bindless = bl;
+
+  /* Slots are filled while the set is bound, most are never written */
+  VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                           VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {};
+  flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  flags_info.pNext = NULL;
+  flags_info.bindingCount = 1;
+  flags_info.pBindingFlags = &binding_flags;
+
+  VkDescriptorSetLayoutBinding binding = {};
+  binding.binding = 0;
+  binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  binding.descriptorCount = capacity;
+  binding.stageFlags = stages;
+  binding.pImmutableSamplers = NULL;
+
+  VkDescriptorSetLayoutCreateInfo layout_info = {};
+  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layout_info.pNext = &flags_info;
+  layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+  layout_info.bindingCount = 1;
+  layout_info.pBindings = &binding;
+
+  res = vkCreateDescriptorSetLayout(device, &layout_info, app->vk_alloc, &bl->layout);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateDescriptorSetLayout"); goto err_destroy; }
+
+  VkDescriptorPoolSize pool_size = {};
+  pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  pool_size.descriptorCount = capacity;
+
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.pNext = NULL;
+  pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+  pool_info.maxSets = 1;
+  pool_info.poolSizeCount = 1;
+  pool_info.pPoolSizes = &pool_size;
+
+  res = vkCreateDescriptorPool(device, &pool_info, app->vk_alloc, &bl->pool);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateDescriptorPool"); goto err_destroy; }
+
+  VkDescriptorSetVariableDescriptorCountAllocateInfo count_info = {};
+  count_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+  count_info.pNext = NULL;
+  count_info.descriptorSetCount = 1;
+  count_info.pDescriptorCounts = &capacity;
+
+  VkDescriptorSetAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  alloc_info.pNext = &count_info;
+  alloc_info.descriptorPool = bl->pool;
+  alloc_info.descriptorSetCount = 1;
+  alloc_info.pSetLayouts = &bl->layout;
+
+  res = vkAllocateDescriptorSets(device, &alloc_info, &bl->set);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateDescriptorSets"); goto err_destroy; }
+
+  return res;
+
+err_destroy:
+  dlu_vk_bindless_destroy(app, cur_ld);
+  return res;
+}
+
+void dlu_vk_bindless_destroy(vkcomp *app, uint32_t cur_ld) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  VkDevice device = app->ld_data[cur_ld].device;
+
+  if (!bl) return;
+
+  /* The set is freed with its pool */
+  if (bl->pool) vkDestroyDescriptorPool(device, bl->pool, app->vk_alloc);
+  if (bl->layout) vkDestroyDescriptorSetLayout(device, bl->layout, app->vk_alloc);
+
+  free(bl);
+  app->ld_data[cur_ld].bindless = NULL;
+}
+
+VkResult dlu_vk_bindless_set_texture(vkcomp *app, uint32_t cur_ld, uint32_t slot, uint32_t cur_tex, VkImageLayout layout) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!bl) { PERR(DLU_VKCOMP_BINDLESS, 0, NULL); return res; }
+  if (slot >= bl->next || !SLOT_USED(bl, slot)) { dlu_log_me(DLU_DANGER, "[x] Bindless slot %u isn't handed out", slot); return res; }
+  if (!app->text_data[cur_tex].view || !app->text_data[cur_tex].sampler) {
+    dlu_log_me(DLU_DANGER, "[x] Texture %u needs an image view and a sampler to be bindless", cur_tex);
+    return res;
+  }
+
+  VkDescriptorImageInfo img_info = {};
+  img_info.sampler = app->text_data[cur_tex].sampler;
+  img_info.imageView = app->text_data[cur_tex].view;
+  img_info.imageLayout = layout;
+
+  VkWriteDescriptorSet write = {};
+  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.pNext = NULL;
+  write.dstSet = bl->set;
+  write.dstBinding = 0;
+  write.dstArrayElement = slot;
+  write.descriptorCount = 1;
+  write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  write.pImageInfo = &img_info;
+
+  vkUpdateDescriptorSets(app->ld_data[cur_ld].device, 1, &write, 0, NULL);
+  bl->textures[slot] = cur_tex;
+
+  return VK_SUCCESS;
+}
+
+VkResult dlu_vk_bindless_set_fallback(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex, VkImageLayout layout) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!bl) { PERR(DLU_VKCOMP_BINDLESS, 0, NULL); return res; }
+  if (!app->text_data[cur_tex].view || !app->text_data[cur_tex].sampler) {
+    dlu_log_me(DLU_DANGER, "[x] Texture %u needs an image view and a sampler to be bindless", cur_tex);
+    return res;
+  }
+
+  bl->fallback = cur_tex;
+  bl->fb_layout = layout;
+
+  return VK_SUCCESS;
+}
+
+bool dlu_vk_bindless_is_fallback(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  return bl && bl->fallback == cur_tex;
+}
+
+void dlu_vk_bindless_evict_texture(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  if (!bl) return;
+
+  for (uint32_t slot = 0; slot < bl->next; slot++) {
+    if (!SLOT_USED(bl, slot) || bl->textures[slot] != cur_tex) continue;
+    if (bl->fallback == UINT32_MAX || dlu_vk_bindless_set_texture(app, cur_ld, slot, bl->fallback, bl->fb_layout)) {
+      dlu_log_me(DLU_WARNING, "Bindless slot %u lost evicted texture %u, giving it back", slot, cur_tex);
+      dlu_vk_bindless_remove(app, cur_ld, slot);
+    }
+  }
+}
+
+uint32_t dlu_vk_bindless_add_texture(vkcomp *app, uint32_t cur_ld, uint32_t cur_tex, VkImageLayout layout) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  uint32_t slot = UINT32_MAX;
+
+  if (!bl) { PERR(DLU_VKCOMP_BINDLESS, 0, NULL); return slot; }
+
+  /* Reuse given back slots first, keeps the indexed range dense */
+  if (bl->free_cnt) slot = bl->free_slots[--bl->free_cnt];
+  else if (bl->next < bl->capacity) slot = bl->next++;
+  else { dlu_log_me(DLU_DANGER, "[x] Bindless table of logical device %u is full (%u slots)", cur_ld, bl->capacity); return slot; }
+
+  bl->used[slot >> 6] |= (UINT64_C(1) << (slot & 63));
+  if (dlu_vk_bindless_set_texture(app, cur_ld, slot, cur_tex, layout)) {
+    bl->used[slot >> 6] &= ~(UINT64_C(1) << (slot & 63));
+    bl->free_slots[bl->free_cnt++] = slot;
+    return UINT32_MAX;
+  }
+
+  return slot;
+}
+
+void dlu_vk_bindless_remove(vkcomp *app, uint32_t cur_ld, uint32_t slot) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  if (!bl || slot >= bl->next) return;
+
+  /* A slot given back twice would be handed out twice and overflow free_slots */
+  if (!SLOT_USED(bl, slot)) { dlu_log_me(DLU_WARNING, "Bindless slot %u is already free", slot); return; }
+
+  /* Descriptor is left as is, partially bound slots only have to be valid when indexed */
+  bl->used[slot >> 6] &= ~(UINT64_C(1) << (slot & 63));
+  bl->free_slots[bl->free_cnt++] = slot;
+}
+
+VkResult dlu_vk_bindless_pipeline_layout(vkcomp *app, uint32_t cur_ld, uint32_t cur_gpd, uint32_t push_size) {
+  dlu_vk_bindless *bl = app->ld_data[cur_ld].bindless;
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!app->gp_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_GP_DATA"); return res; }
+  if (!bl) { PERR(DLU_VKCOMP_BINDLESS, 0, NULL); return res; }
+
+  VkPushConstantRange push_range = {};
+  push_range.stageFlags = bl->stages;
+  push_range.offset = 0;
+  push_range.size = push_size;
+
+  VkPipelineLayoutCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.setLayoutCount = 1;
+  create_info.pSetLayouts = &bl->layout;
+  create_info.pushConstantRangeCount = (push_size) ? 1 : 0;
+  create_info.pPushConstantRanges = (push_size) ? &push_range : NULL;
+
+  res = vkCreatePipelineLayout(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &app->gp_data[cur_gpd].pipeline_layout);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreatePipelineLayout"); return res; }
+
+  /* Associate a logical device with a graphics pipeline */
+  app->gp_data[cur_gpd].ldi = cur_ld;
+
+  return res;
+}
+
+void dlu_vk_bindless_bind(vkcomp *app, uint32_t cur_gpd, VkCommandBuffer cmd_buff, VkPipelineBindPoint bind_point) {
+  dlu_vk_bindless *bl = app->ld_data[app->gp_data[cur_gpd].ldi].bindless;
+  if (!bl) { PERR(DLU_VKCOMP_BINDLESS, 0, NULL); return; }
+
+  vkCmdBindDescriptorSets(cmd_buff, bind_point, app->gp_data[cur_gpd].pipeline_layout, 0, 1, &bl->set, 0, NULL);
+}
+
+void dlu_vk_bindless_push(vkcomp *app, uint32_t cur_gpd, VkCommandBuffer cmd_buff, uint32_t size, const void *data) {
+  dlu_vk_bindless *bl = app->ld_data[app->gp_data[cur_gpd].ldi].bindless;
+  if (!bl) { PERR(DLU_VKCOMP_BINDLESS, 0, NULL); return; }
+
+  vkCmdPushConstants(cmd_buff, app->gp_data[cur_gpd].pipeline_layout, bl->stages, 0, size, data);
+}
@@ -75,7 +75,7 @@ VkResult dlu_create_instance(
   create_info.ppEnabledExtensionNames = ppEnabledExtensionNames;
 
   /* Create the instance */
-  res = vkCreateInstance(&create_info, NULL, &app->instance);
+  res = vkCreateInstance(&create_info, app->vk_alloc, &app->instance);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateInstance")
 
   return res;
@@ -93,7 +93,7 @@ VkResult dlu_create_vkwayland_surfaceKHR(vkcomp *app, void *wl_display, void *wl
   create_info.display = (struct wl_display *) wl_display;
   create_info.surface = (struct wl_surface *) wl_surface;
 
-  res = vkCreateWaylandSurfaceKHR(app->instance, &create_info, NULL, &app->surface);
+  res = vkCreateWaylandSurfaceKHR(app->instance, &create_info, app->vk_alloc, &app->surface);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateWaylandSurfaceKHR")
 
   return res;
@@ -186,10 +186,17 @@ VkBool32 dlu_create_queue_families(vkcomp *app, uint32_t cur_pd, VkQueueFlagBits
         dlu_log_me(DLU_SUCCESS, "Physical Device Queue Family Index %d has support for commute operations", i);
       }
 
-      if (vkqfbits & VK_QUEUE_TRANSFER_BIT && app->pd_data[cur_pd].tfam_idx == UINT32_MAX) {
+      /**
+      * Prefer a family dedicated to transfers (no graphics or compute), its queues are
+      * usually backed by DMA engines that copy while the graphics queue renders.
+      */
+      uint32_t tfam_idx = app->pd_data[cur_pd].tfam_idx;
+      bool dedicated = !(queue_families[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+      if (vkqfbits & VK_QUEUE_TRANSFER_BIT && queue_families[i].queueFlags & VK_QUEUE_TRANSFER_BIT &&
+          (tfam_idx == UINT32_MAX || (dedicated && queue_families[tfam_idx].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))) {
         /* Retrieve Transfer Family Queue index */
         app->pd_data[cur_pd].tfam_idx = i; ret = VK_FALSE;
-        dlu_log_me(DLU_SUCCESS, "Physical Device Queue Family Index %d has support for transfer operations", i);
+        dlu_log_me(DLU_SUCCESS, "Physical Device Queue Family Index %d has support for%s transfer operations", i, (dedicated) ? " dedicated" : "");
       }
     }
   }
@@ -197,6 +204,29 @@ VkBool32 dlu_create_queue_families(vkcomp *app, uint32_t cur_pd, VkQueueFlagBits
   return ret;
 }
 
+/**
+* Core since Vulkan 1.1, before that only through VK_KHR_get_physical_device_properties2.
+* The instance is created for 1.0, the core entry points work if the physical device is newer
+*/
+static bool get_phys_dev_procs2(vkcomp *app, VkPhysicalDevice phys_dev) {
+  if (app->get_feats2 && app->get_props2) return true;
+
+  VkPhysicalDeviceProperties props;
+  vkGetPhysicalDeviceProperties(phys_dev, &props);
+
+  /* Same signatures, the extension only suffixes the names */
+  bool core = (props.apiVersion >= VK_API_VERSION_1_1);
+  app->get_feats2 = (PFN_vkGetPhysicalDeviceFeatures2) vkGetInstanceProcAddr(app->instance, (core) ? "vkGetPhysicalDeviceFeatures2" : "vkGetPhysicalDeviceFeatures2KHR");
+  app->get_props2 = (PFN_vkGetPhysicalDeviceProperties2) vkGetInstanceProcAddr(app->instance, (core) ? "vkGetPhysicalDeviceProperties2" : "vkGetPhysicalDeviceProperties2KHR");
+
+  return app->get_feats2 && app->get_props2;
+}
+
+static bool has_feature(uint32_t cur_pd, VkBool32 supported, const char *feature, const char *ext) {
+  if (!supported) dlu_log_me(DLU_DANGER, "[x] Physical device %u lacks %s, %s needs it", cur_pd, feature, ext);
+  return supported;
+}
+
 VkResult dlu_create_logical_device(
   vkcomp *app,
   uint32_t cur_pd,
@@ -214,9 +244,89 @@ VkResult dlu_create_logical_device(
   if (!app->ld_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_LD_DATA"); return res; }  
   if (!app->pd_data[cur_pd].phys_dev) { PERR(DLU_VKCOMP_PHYS_DEV, 0, NULL); return res; }
 
+  /**
+  * Bindless rendering and timeline semaphore extensions get the features they exist for enabled,
+  * once the physical device is known to support them
+  */
+  bool bda = false, desc_indexing = false, timeline = false;
+  for (uint32_t i = 0; i < enabledExtensionCount; i++) {
+    if (!strcmp(ppEnabledExtensionNames[i], VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME)) bda = true;
+    if (!strcmp(ppEnabledExtensionNames[i], VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) desc_indexing = true;
+    if (!strcmp(ppEnabledExtensionNames[i], VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) timeline = true;
+  }
+
+  if ((bda || desc_indexing || timeline) && !get_phys_dev_procs2(app, app->pd_data[cur_pd].phys_dev)) {
+    dlu_log_me(DLU_DANGER, "[x] Querying device features requires Vulkan 1.1 or the instance to enable %s", VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+  }
+
+  VkPhysicalDeviceBufferDeviceAddressFeatures bda_sup = {};
+  bda_sup.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+  bda_sup.pNext = NULL;
+
+  VkPhysicalDeviceTimelineSemaphoreFeatures timeline_sup = {};
+  timeline_sup.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  timeline_sup.pNext = &bda_sup;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexing_sup = {};
+  indexing_sup.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  indexing_sup.pNext = &timeline_sup;
+
+  VkPhysicalDeviceFeatures2 feats2 = {};
+  feats2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  feats2.pNext = &indexing_sup;
+
+  if (bda || desc_indexing || timeline)
+    app->get_feats2(app->pd_data[cur_pd].phys_dev, &feats2);
+
+  /* Every missing feature is reported, not just the first */
+  bool supported = true;
+  if (bda)
+    supported &= has_feature(cur_pd, bda_sup.bufferDeviceAddress, "bufferDeviceAddress", VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+  if (timeline)
+    supported &= has_feature(cur_pd, timeline_sup.timelineSemaphore, "timelineSemaphore", VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+  if (desc_indexing) {
+    /* Shaders declare the table as an unsized array and index it with nonuniformEXT */
+    supported &= has_feature(cur_pd, indexing_sup.shaderSampledImageArrayNonUniformIndexing, "shaderSampledImageArrayNonUniformIndexing", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    supported &= has_feature(cur_pd, indexing_sup.runtimeDescriptorArray, "runtimeDescriptorArray", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    /* Binding flags of the bindless table, see dlu_vk_bindless_create(3) */
+    supported &= has_feature(cur_pd, indexing_sup.descriptorBindingSampledImageUpdateAfterBind, "descriptorBindingSampledImageUpdateAfterBind", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    supported &= has_feature(cur_pd, indexing_sup.descriptorBindingUpdateUnusedWhilePending, "descriptorBindingUpdateUnusedWhilePending", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    supported &= has_feature(cur_pd, indexing_sup.descriptorBindingPartiallyBound, "descriptorBindingPartiallyBound", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    supported &= has_feature(cur_pd, indexing_sup.descriptorBindingVariableDescriptorCount, "descriptorBindingVariableDescriptorCount", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+  }
+
+  if (!supported) return VK_ERROR_FEATURE_NOT_PRESENT;
+
+  VkPhysicalDeviceBufferDeviceAddressFeatures bda_feats = {};
+  bda_feats.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+  bda_feats.pNext = NULL;
+  bda_feats.bufferDeviceAddress = VK_TRUE;
+
+  VkPhysicalDeviceTimelineSemaphoreFeatures timeline_feats = {};
+  timeline_feats.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  timeline_feats.pNext = NULL;
+  timeline_feats.timelineSemaphore = VK_TRUE;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexing_feats = {};
+  indexing_feats.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  indexing_feats.pNext = NULL;
+  indexing_feats.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+  indexing_feats.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  indexing_feats.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+  indexing_feats.descriptorBindingPartiallyBound = VK_TRUE;
+  indexing_feats.descriptorBindingVariableDescriptorCount = VK_TRUE;
+  indexing_feats.runtimeDescriptorArray = VK_TRUE;
+
+  /* Chain the feature structs of the requested extensions */
+  void *feats = NULL;
+  if (bda) { bda_feats.pNext = feats; feats = &bda_feats; }
+  if (timeline) { timeline_feats.pNext = feats; feats = &timeline_feats; }
+  if (desc_indexing) { indexing_feats.pNext = feats; feats = &indexing_feats; }
+
   VkDeviceCreateInfo create_info = {};
   create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-  create_info.pNext = NULL;
+  create_info.pNext = feats;
   create_info.flags = flags;
   create_info.queueCreateInfoCount = queueCreateInfoCount;
   create_info.pQueueCreateInfos = pQueueCreateInfos;
@@ -227,12 +337,31 @@ VkResult dlu_create_logical_device(
   create_info.pEnabledFeatures = pEnabledFeatures;
 
   /* Create logic device */
-  res = vkCreateDevice(app->pd_data[cur_pd].phys_dev, &create_info, NULL, &app->ld_data[cur_ld].device);
+  res = vkCreateDevice(app->pd_data[cur_pd].phys_dev, &create_info, app->vk_alloc, &app->ld_data[cur_ld].device);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateDevice"); return res; }
 
   /* Associate a logical device with a given physical */
   app->ld_data[cur_ld].pdi = cur_pd;
 
+  /* Budget queries need vkGetPhysicalDeviceMemoryProperties2 (VK_KHR_get_physical_device_properties2) */
+  for (uint32_t i = 0; i < enabledExtensionCount; i++) {
+    if (strcmp(ppEnabledExtensionNames[i], VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) continue;
+    if (!app->get_mem_props2)
+      DLU_DR_INSTANCE_PROC_ADDR(app->instance, app->get_mem_props2, GetPhysicalDeviceMemoryProperties2KHR);
+    app->ld_data[cur_ld].budget_ext = (app->get_mem_props2 != NULL);
+  }
+
+  if (bda) {
+    DLU_DR_DEVICE_PROC_ADDR(app->ld_data[cur_ld].device, app->ld_data[cur_ld].get_buff_addr, GetBufferDeviceAddressKHR);
+    app->ld_data[cur_ld].bda = (app->ld_data[cur_ld].get_buff_addr != NULL);
+  }
+
+  if (timeline) {
+    DLU_DR_DEVICE_PROC_ADDR(app->ld_data[cur_ld].device, app->ld_data[cur_ld].wait_sems, WaitSemaphoresKHR);
+    DLU_DR_DEVICE_PROC_ADDR(app->ld_data[cur_ld].device, app->ld_data[cur_ld].get_sem_value, GetSemaphoreCounterValueKHR);
+    app->ld_data[cur_ld].timeline = (app->ld_data[cur_ld].wait_sems && app->ld_data[cur_ld].get_sem_value);
+  }
+
   return res;
 }
 
@@ -298,7 +427,7 @@ VkResult dlu_create_swap_chain(
     }
   }
 
-  res = vkCreateSwapchainKHR(app->ld_data[cur_ld].device, create_info, NULL, &app->sc_data[cur_scd].swap_chain);
+  res = vkCreateSwapchainKHR(app->ld_data[cur_ld].device, create_info, app->vk_alloc, &app->sc_data[cur_scd].swap_chain);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateSwapchainKHR"); }
 
   VkImage *imgs = VK_NULL_HANDLE;
@@ -317,7 +446,7 @@ VkResult dlu_create_swap_chain(
 
   for (uint32_t i = 0; i < app->sc_data[cur_scd].sic; i++) {
     ivi->image = app->sc_data[cur_scd].sc_buffs[i].image = imgs[i];
-    res = vkCreateImageView(app->ld_data[cur_ld].device, ivi, NULL, &app->sc_data[cur_scd].sc_buffs[i].view);
+    res = vkCreateImageView(app->ld_data[cur_ld].device, ivi, app->vk_alloc, &app->sc_data[cur_scd].sc_buffs[i].view);
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateImageView"); return res; }
   }
 
@@ -327,21 +456,26 @@ VkResult dlu_create_swap_chain(
   return res;
 }
 
-VkResult dlu_create_depth_buff(
+/* Create a swap chain wide attachment (depth or multisampled color), its memory and its view */
+static VkResult create_sc_attachment(
   vkcomp *app,
   uint32_t cur_scd,
   VkImageCreateInfo *img_info,
   VkImageViewCreateInfo *ivi,
-  VkMemoryPropertyFlags requirements_mask
+  VkMemoryPropertyFlags requirements_mask,
+  struct _sc_attachment *att
 ) {
 
   VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = VK_NULL_HANDLE;
+  uint32_t type_idx = 0;
 
-  if (!app->sc_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_SC_DATA"); return res; }
   if (app->sc_data[cur_scd].ldi == UINT32_MAX) { PERR(DLU_VKCOMP_DEVICE_NOT_ASSOC, 0, "dlu_create_swap_chain()"); return res; }
 
+  device = app->ld_data[app->sc_data[cur_scd].ldi].device;
+
   /* Create image object */
-  res = vkCreateImage(app->ld_data[app->sc_data[cur_scd].ldi].device, img_info, NULL, &app->sc_data[cur_scd].depth.image);
+  res = vkCreateImage(device, img_info, app->vk_alloc, &att->image);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateImage"); return res; }
 
   /**
@@ -352,44 +486,62 @@ VkResult dlu_create_depth_buff(
   * memory for an image.
   */
   VkMemoryRequirements mem_reqs;
-  vkGetImageMemoryRequirements(app->ld_data[app->sc_data[cur_scd].ldi].device, app->sc_data[cur_scd].depth.image, &mem_reqs);
-
-  VkMemoryAllocateInfo mem_alloc = {};
-  mem_alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  mem_alloc.pNext = NULL;
-  mem_alloc.allocationSize = mem_reqs.size;
-  mem_alloc.memoryTypeIndex = 0;
-
-  VkBool32 pass; /* find a suitable memory type for depth bufffer */
-  pass = memory_type_from_properties(app, app->ld_data[app->sc_data[cur_scd].ldi].pdi, mem_reqs.memoryTypeBits, requirements_mask, &mem_alloc.memoryTypeIndex);
-  if (!pass) {
-    dlu_log_me(DLU_DANGER, "[x] memory_type_from_properties failed");
-    return pass;
-  }
-
-  /* Allocate memory */
-  res = vkAllocateMemory(app->ld_data[app->sc_data[cur_scd].ldi].device, &mem_alloc, NULL, &app->sc_data[cur_scd].depth.mem);
-  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateMemory"); return res; }
+  vkGetImageMemoryRequirements(device, att->image, &mem_reqs);
 
   /**
-  * Associate the memory allocated with the VkImage resource.
-  * It is easier to attach the entire VkDeviceMemory to the VkImage resource
-  * So offset will always be zero whenever a call to vkBind*Memory is called
+  * Transient attachments live and die within a render pass. On tiled GPUs they never
+  * leave tile memory, so lazily allocated memory is never actually committed. Only ask
+  * for it if a type has it, dlu_vk_mem_alloc(3) then picks that type and never pools it
   */
-  res = vkBindImageMemory(app->ld_data[app->sc_data[cur_scd].ldi].device, app->sc_data[cur_scd].depth.image, app->sc_data[cur_scd].depth.mem, 0);
+  if (img_info->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
+    if (memory_type_from_properties(app, app->ld_data[app->sc_data[cur_scd].ldi].pdi, mem_reqs.memoryTypeBits,
+                                    requirements_mask | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &type_idx))
+      requirements_mask |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+  }
+
+  /* Sub-allocate from the device memory pool, lazily allocated memory is dedicated */
+  res = dlu_vk_mem_alloc(app, app->sc_data[cur_scd].ldi, &mem_reqs, requirements_mask, img_info->tiling == VK_IMAGE_TILING_LINEAR, &att->mem, &att->sub);
+  if (res) return res;
+
+  /* Associate the range of pooled memory with the VkImage resource */
+  res = vkBindImageMemory(device, att->image, att->mem, att->sub.offset);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBindImageMemory"); return res; }
 
   if (ivi->format == VK_FORMAT_D16_UNORM_S8_UINT || ivi->format == VK_FORMAT_D24_UNORM_S8_UINT || ivi->format == VK_FORMAT_D32_SFLOAT_S8_UINT)
     ivi->subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
 
-  /* Create an image view object for depth buffer */
-  ivi->image = app->sc_data[cur_scd].depth.image;
-  res = vkCreateImageView(app->ld_data[app->sc_data[cur_scd].ldi].device, ivi, NULL, &app->sc_data[cur_scd].depth.view);
+  /* Create an image view object for the attachment */
+  ivi->image = att->image;
+  res = vkCreateImageView(device, ivi, app->vk_alloc, &att->view);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateImageView")
- 
+
   return res;
 }
 
+VkResult dlu_create_depth_buff(
+  vkcomp *app,
+  uint32_t cur_scd,
+  VkImageCreateInfo *img_info,
+  VkImageViewCreateInfo *ivi,
+  VkMemoryPropertyFlags requirements_mask
+) {
+
+  if (!app->sc_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_SC_DATA"); return VK_RESULT_MAX_ENUM; }
+  return create_sc_attachment(app, cur_scd, img_info, ivi, requirements_mask, &app->sc_data[cur_scd].depth);
+}
+
+VkResult dlu_create_msaa_color_buff(
+  vkcomp *app,
+  uint32_t cur_scd,
+  VkImageCreateInfo *img_info,
+  VkImageViewCreateInfo *ivi,
+  VkMemoryPropertyFlags requirements_mask
+) {
+
+  if (!app->sc_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_SC_DATA"); return VK_RESULT_MAX_ENUM; }
+  return create_sc_attachment(app, cur_scd, img_info, ivi, requirements_mask, &app->sc_data[cur_scd].msaa);
+}
+
 VkResult dlu_create_vk_buffer(
   vkcomp *app,
   uint32_t cur_ld,
@@ -406,6 +558,10 @@ VkResult dlu_create_vk_buffer(
   VkResult res = VK_RESULT_MAX_ENUM;
 
   if (!app->buff_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_BUFF_DATA"); return res; }
+  if ((usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) && !app->ld_data[cur_ld].bda) {
+    dlu_log_me(DLU_DANGER, "[x] Buffer device address requires the logical device to enable %s", VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+    return res;
+  }
 
   VkBufferCreateInfo create_info = {};
   create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -417,7 +573,7 @@ VkResult dlu_create_vk_buffer(
   create_info.queueFamilyIndexCount = queueFamilyIndexCount;
   create_info.pQueueFamilyIndices = pQueueFamilyIndices;
 
-  res = vkCreateBuffer(app->ld_data[cur_ld].device, &create_info, NULL, &app->buff_data[cur_bd].buff);
+  res = vkCreateBuffer(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &app->buff_data[cur_bd].buff);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateBuffer"); return res; }
 
   /* Associate a buffer with a VkDevice */
@@ -426,26 +582,22 @@ VkResult dlu_create_vk_buffer(
   VkMemoryRequirements mem_reqs;
   vkGetBufferMemoryRequirements(app->ld_data[cur_ld].device, app->buff_data[cur_bd].buff, &mem_reqs);
 
-  VkMemoryAllocateInfo alloc_info = {};
-  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  alloc_info.pNext = NULL;
-  alloc_info.allocationSize = mem_reqs.size;
-  alloc_info.memoryTypeIndex = 0;
-
-  /* find a suitable memory type for VkBuffer */
-  res = memory_type_from_properties(app, app->ld_data[cur_ld].pdi, mem_reqs.memoryTypeBits, requirements_mask, &alloc_info.memoryTypeIndex);
-  if (!res) { PERR(DLU_MEM_TYPE_ERR, 0, NULL) return res; }
-
-  res = vkAllocateMemory(app->ld_data[cur_ld].device, &alloc_info, NULL, &app->buff_data[cur_bd].mem);
-  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateMemory"); return res; }
-
-  /**
-  * Associate the memory allocated with the VkBuffer resource.
-  * It is easier to attach the entire VkDeviceMemory to the VkBuffer resource
-  * So offset will always be zero whenever a call to vkBind*Memory is called
-  */
-  res = vkBindBufferMemory(app->ld_data[cur_ld].device, app->buff_data[cur_bd].buff, app->buff_data[cur_bd].mem, 0);
-  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkBindBufferMemory")
+  /* Sub-allocate from the device memory pool, buffers are always linear resources */
+  res = dlu_vk_mem_alloc(app, cur_ld, &mem_reqs, requirements_mask, true, &app->buff_data[cur_bd].mem, &app->buff_data[cur_bd].sub);
+  if (res) return res;
+
+  /* Associate the range of pooled memory with the VkBuffer resource */
+  res = vkBindBufferMemory(app->ld_data[cur_ld].device, app->buff_data[cur_bd].buff, app->buff_data[cur_bd].mem, app->buff_data[cur_bd].sub.offset);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBindBufferMemory"); return res; }
+
+  app->buff_data[cur_bd].addr = 0;
+  if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+    VkBufferDeviceAddressInfo addr_info = {};
+    addr_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    addr_info.pNext = NULL;
+    addr_info.buffer = app->buff_data[cur_bd].buff;
+    app->buff_data[cur_bd].addr = app->ld_data[cur_ld].get_buff_addr(app->ld_data[cur_ld].device, &addr_info);
+  }
 
   return res;
 }
@@ -478,7 +630,7 @@ VkResult dlu_create_framebuffers(
     pAttachments[0] = app->sc_data[cur_scd].sc_buffs[i].view;
     create_info.pAttachments = pAttachments;
 
-    res = vkCreateFramebuffer(app->ld_data[app->sc_data[cur_scd].ldi].device, &create_info, NULL, &app->sc_data[cur_scd].sc_buffs[i].fb);
+    res = vkCreateFramebuffer(app->ld_data[app->sc_data[cur_scd].ldi].device, &create_info, app->vk_alloc, &app->sc_data[cur_scd].sc_buffs[i].fb);
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateFramebuffer"); return res; }
   }
 
@@ -504,11 +656,12 @@ VkResult dlu_create_cmd_pool(
   create_info.flags = flags;
   create_info.queueFamilyIndex = queueFamilyIndex;
 
-  res = vkCreateCommandPool(app->ld_data[cur_ld].device, &create_info, NULL, &app->cmd_data[cur_cmdd].cmd_pool);
+  res = vkCreateCommandPool(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &app->cmd_data[cur_cmdd].cmd_pool);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateCommandPool"); return res; }
 
   /* Associate a command pool with a logical device */
   app->cmd_data[cur_cmdd].ldi = cur_ld;
+  app->cmd_data[cur_cmdd].flags = flags;
 
   return res;
 }
@@ -562,13 +715,13 @@ VkResult dlu_create_syncs(vkcomp *app, uint32_t cur_scd) {
   fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
   for (uint32_t i = 0; i < app->sc_data[cur_scd].sic; i++) {
-    res = vkCreateSemaphore(app->ld_data[app->sc_data[cur_scd].ldi].device, &sem_info, NULL, &app->sc_data[cur_scd].syncs[i].sem.image);
+    res = vkCreateSemaphore(app->ld_data[app->sc_data[cur_scd].ldi].device, &sem_info, app->vk_alloc, &app->sc_data[cur_scd].syncs[i].sem.image);
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateSemaphore"); return res; }
 
-    res = vkCreateSemaphore(app->ld_data[app->sc_data[cur_scd].ldi].device, &sem_info, NULL, &app->sc_data[cur_scd].syncs[i].sem.render);
+    res = vkCreateSemaphore(app->ld_data[app->sc_data[cur_scd].ldi].device, &sem_info, app->vk_alloc, &app->sc_data[cur_scd].syncs[i].sem.render);
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateSemaphore"); return res; }
 
-    res = vkCreateFence(app->ld_data[app->sc_data[cur_scd].ldi].device, &fence_info, NULL, &app->sc_data[cur_scd].syncs[i].fence.render);
+    res = vkCreateFence(app->ld_data[app->sc_data[cur_scd].ldi].device, &fence_info, app->vk_alloc, &app->sc_data[cur_scd].syncs[i].fence.render);
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateFence"); return res; }
   }
 
@@ -589,7 +742,7 @@ VkShaderModule dlu_create_shader_module(vkcomp *app, uint32_t cur_ld, char *code
   create_info.codeSize = code_size;
   create_info.pCode = (const uint32_t *) code;
 
-  err = vkCreateShaderModule(app->ld_data[cur_ld].device, &create_info, NULL, &shader_module);
+  err = vkCreateShaderModule(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &shader_module);
   if (err) PERR(DLU_VK_FUNC_ERR, err, "vkCreateShaderModule");
 
   if (err == VK_SUCCESS) dlu_log_me(DLU_SUCCESS, "Shader module successfully created");
@@ -626,7 +779,7 @@ VkResult dlu_create_render_pass(
   render_pass_info.dependencyCount = dependencyCount;
   render_pass_info.pDependencies = pDependencies;
 
-  res = vkCreateRenderPass(app->ld_data[app->gp_data[cur_gpd].ldi].device, &render_pass_info, NULL, &app->gp_data[cur_gpd].render_pass);
+  res = vkCreateRenderPass(app->ld_data[app->gp_data[cur_gpd].ldi].device, &render_pass_info, app->vk_alloc, &app->gp_data[cur_gpd].render_pass);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateRenderPass");
 
   return res;
@@ -677,7 +830,7 @@ VkResult dlu_create_graphics_pipelines(
   pipeline_info.basePipelineHandle = basePipelineHandle;
   pipeline_info.basePipelineIndex = basePipelineIndex;
 
-  res = vkCreateGraphicsPipelines(app->ld_data[app->gp_data[cur_gpd].ldi].device, app->gp_cache.pipe_cache, 1, &pipeline_info, NULL, app->gp_data[cur_gpd].graphics_pipelines);
+  res = vkCreateGraphicsPipelines(app->ld_data[app->gp_data[cur_gpd].ldi].device, app->gp_cache.pipe_cache, 1, &pipeline_info, app->vk_alloc, app->gp_data[cur_gpd].graphics_pipelines);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateGraphicsPipelines"); }
 
   return res;
@@ -694,7 +847,7 @@ VkResult dlu_create_pipeline_cache(vkcomp *app, uint32_t cur_ld, size_t initialD
   create_info.initialDataSize = initialDataSize;
   create_info.pInitialData = pInitialData;
 
-  res = vkCreatePipelineCache(app->ld_data[cur_ld].device, &create_info, NULL, &app->gp_cache.pipe_cache);
+  res = vkCreatePipelineCache(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &app->gp_cache.pipe_cache);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreatePipelineCache");
 
   /* Associate a VkPipelineCache with a VkDevice */
@@ -720,7 +873,7 @@ VkResult dlu_create_pipeline_layout(
 
   VkDescriptorSetLayout  *pSetLayouts  = (layout_infos) ? alloca(layout_count * sizeof(VkDescriptorSetLayout)) :  NULL;
   for (uint32_t i = 0; i < layout_count; i++) {
-    res = vkCreateDescriptorSetLayout(app->ld_data[cur_ld].device, &layout_infos[i], NULL, &pSetLayouts[i]);
+    res = vkCreateDescriptorSetLayout(app->ld_data[cur_ld].device, &layout_infos[i], app->vk_alloc, &pSetLayouts[i]);
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateDescriptorSetLayout"); goto end_func; }
   }
 
@@ -733,7 +886,7 @@ VkResult dlu_create_pipeline_layout(
   create_info.pushConstantRangeCount = pushConstantRangeCount;
   create_info.pPushConstantRanges = pPushConstantRanges;
 
-  res = vkCreatePipelineLayout(app->ld_data[cur_ld].device, &create_info, NULL, &app->gp_data[cur_gpd].pipeline_layout);
+  res = vkCreatePipelineLayout(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &app->gp_data[cur_gpd].pipeline_layout);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreatePipelineLayout")
 
   /* Associate a logical device with a graphics pipeline */
@@ -742,7 +895,7 @@ VkResult dlu_create_pipeline_layout(
 end_func:
   for (uint32_t i = 0; i < layout_count; i++)
     if (pSetLayouts[i])
-      vkDestroyDescriptorSetLayout(app->ld_data[cur_ld].device, pSetLayouts[i], NULL);
+      vkDestroyDescriptorSetLayout(app->ld_data[cur_ld].device, pSetLayouts[i], app->vk_alloc);
 
   return res;
 }
@@ -758,7 +911,7 @@ VkResult dlu_create_desc_set_layout(
   if (!app->desc_data[cur_dd].layouts) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_DESC_DATA_MEMS"); return res; }
   if (app->desc_data[cur_dd].ldi == UINT32_MAX) { PERR(DLU_VKCOMP_DEVICE_NOT_ASSOC, 0, "dlu_create_desc_pool(3)"); return res; }
 
-  res = vkCreateDescriptorSetLayout(app->ld_data[app->desc_data[cur_dd].ldi].device, desc_set_info, NULL, &app->desc_data[cur_dd].layouts[cur_dl]);
+  res = vkCreateDescriptorSetLayout(app->ld_data[app->desc_data[cur_dd].ldi].device, desc_set_info, app->vk_alloc, &app->desc_data[cur_dd].layouts[cur_dl]);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateDescriptorSetLayout")
 
   return res;
@@ -783,7 +936,7 @@ VkResult dlu_create_desc_pool(
   create_info.poolSizeCount = psize;
   create_info.pPoolSizes = pool_sizes;
 
-  res = vkCreateDescriptorPool(app->ld_data[cur_ld].device, &create_info, NULL, &app->desc_data[cur_dd].desc_pool);
+  res = vkCreateDescriptorPool(app->ld_data[cur_ld].device, &create_info, app->vk_alloc, &app->desc_data[cur_dd].desc_pool);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateDescriptorPool");
 
   app->desc_data[cur_dd].ldi = cur_ld;
@@ -836,7 +989,7 @@ VkResult dlu_create_texture_image(
 
   if (!app->text_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_TEXT_DATA"); return res; }
 
-  res = vkCreateImage(app->ld_data[cur_ld].device, img_info, NULL, &app->text_data[cur_tex].image);
+  res = vkCreateImage(app->ld_data[cur_ld].device, img_info, app->vk_alloc, &app->text_data[cur_tex].image);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateImage"); }
 
   /**
@@ -849,25 +1002,13 @@ VkResult dlu_create_texture_image(
   VkMemoryRequirements mem_reqs;
   vkGetImageMemoryRequirements(app->ld_data[cur_ld].device, app->text_data[cur_tex].image, &mem_reqs);
 
-  VkMemoryAllocateInfo alloc_info = {};
-  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  alloc_info.pNext = NULL;
-  alloc_info.allocationSize = mem_reqs.size;
-  alloc_info.memoryTypeIndex = 0;
-
-  /* find a suitable memory type for image */
-  res = memory_type_from_properties(app, app->ld_data[cur_ld].pdi, mem_reqs.memoryTypeBits, requirements_mask, &alloc_info.memoryTypeIndex);
-  if (!res) { PERR(DLU_MEM_TYPE_ERR, 0, NULL); return res; }
-
-  res = vkAllocateMemory(app->ld_data[cur_ld].device, &alloc_info, NULL, &app->text_data[cur_tex].mem);
-  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateMemory"); return res; }
+  /* Sub-allocate from the device memory pool */
+  res = dlu_vk_mem_alloc(app, cur_ld, &mem_reqs, requirements_mask, img_info->tiling == VK_IMAGE_TILING_LINEAR,
+                         &app->text_data[cur_tex].mem, &app->text_data[cur_tex].sub);
+  if (res) return res;
 
-  /**
-  * Associate the memory allocated with the VkBuffer resource.
-  * It is easier to attach the entire VkDeviceMemory to the VkBuffer resource
-  * So offset will always be zero whenever a call to vkBind*Memory is called
-  */
-  res = vkBindImageMemory(app->ld_data[cur_ld].device, app->text_data[cur_tex].image, app->text_data[cur_tex].mem, 0);
+  /* Associate the range of pooled memory with the VkImage resource */
+  res = vkBindImageMemory(app->ld_data[cur_ld].device, app->text_data[cur_tex].image, app->text_data[cur_tex].mem, app->text_data[cur_tex].sub.offset);
   if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBindImageMemory"); return res; }
 
   /**
@@ -875,11 +1016,12 @@ VkResult dlu_create_texture_image(
   * but for reduncy and to ensure the image is correct assigning it here.
   */
   ivi->image = app->text_data[cur_tex].image;
-  res = vkCreateImageView(app->ld_data[cur_ld].device, ivi, NULL, &app->text_data[cur_tex].view);
+  res = vkCreateImageView(app->ld_data[cur_ld].device, ivi, app->vk_alloc, &app->text_data[cur_tex].view);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateImageView")
 
   /* Associate a texture with a given VkDevice */
   app->text_data[cur_tex].ldi = cur_ld;
+  app->text_data[cur_tex].evicted = false;
 
   return res;
 }
@@ -889,7 +1031,7 @@ VkResult dlu_create_texture_sampler(vkcomp *app, uint32_t cur_tex, VkSamplerCrea
 
   if (!app->text_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_TEXT_DATA"); return res; }
 
-  res = vkCreateSampler(app->ld_data[app->text_data[cur_tex].ldi].device, sample_info, NULL, &app->text_data[cur_tex].sampler);
+  res = vkCreateSampler(app->ld_data[app->text_data[cur_tex].ldi].device, sample_info, app->vk_alloc, &app->text_data[cur_tex].sampler);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateSampler")
 
   return res;
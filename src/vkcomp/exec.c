@@ -80,6 +80,136 @@ finish_estcb:
   return res;
 }
 
+static struct _cmd_batch *get_batch(vkcomp *app, uint32_t cur_pool, uint64_t ticket) {
+  return &app->cmd_data[cur_pool].batches[(ticket - 1) % DLU_EXEC_BATCH_CNT];
+}
+
+VkCommandBuffer dlu_exec_begin_batch(vkcomp *app, uint32_t cur_pool) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!app->cmd_data[cur_pool].cmd_pool) { PERR(DLU_VKCOMP_CMD_POOL, 0, NULL); return VK_NULL_HANDLE; }
+
+  struct _cmd_data *cd = &app->cmd_data[cur_pool];
+  VkDevice device = app->ld_data[cd->ldi].device;
+  uint64_t ticket = cd->submitted + 1;
+  struct _cmd_batch *batch = get_batch(app, cur_pool, ticket);
+
+  if (batch->recording) return batch->cmd_buff;
+
+  if (!batch->fence) {
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_info.pNext = NULL;
+
+    res = vkCreateFence(device, &fence_info, app->vk_alloc, &batch->fence);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateFence"); return VK_NULL_HANDLE; }
+  }
+
+  /* The slot's previous batch must finish before its command buffer can be reused */
+  if (batch->ticket) {
+    res = vkWaitForFences(device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences"); return VK_NULL_HANDLE; }
+
+    res = vkResetFences(device, 1, &batch->fence);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkResetFences"); return VK_NULL_HANDLE; }
+    batch->ticket = 0;
+
+    /* Individual command buffers can only be reset with the pool flag, else allocate a new one */
+    if (cd->flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT) {
+      res = vkResetCommandBuffer(batch->cmd_buff, 0);
+      if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkResetCommandBuffer"); goto free_cmd_buff; }
+
+      VkCommandBufferBeginInfo begin_info = {};
+      begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+      begin_info.pNext = NULL;
+      begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+      res = vkBeginCommandBuffer(batch->cmd_buff, &begin_info);
+      if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); goto free_cmd_buff; }
+    } else {
+      vkFreeCommandBuffers(device, cd->cmd_pool, 1, &batch->cmd_buff);
+      batch->cmd_buff = VK_NULL_HANDLE;
+    }
+  }
+
+  if (!batch->cmd_buff) {
+    batch->cmd_buff = dlu_exec_begin_single_time_cmd_buff(app, cur_pool);
+    if (!batch->cmd_buff) return VK_NULL_HANDLE;
+  }
+
+  batch->ticket = ticket;
+  batch->recording = true;
+
+  return batch->cmd_buff;
+
+free_cmd_buff:
+  vkFreeCommandBuffers(device, cd->cmd_pool, 1, &batch->cmd_buff);
+  batch->cmd_buff = VK_NULL_HANDLE;
+  return VK_NULL_HANDLE;
+}
+
+VkResult dlu_exec_submit_batch(vkcomp *app, uint32_t cur_pool, uint64_t *ticket) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!app->cmd_data[cur_pool].cmd_pool) { PERR(DLU_VKCOMP_CMD_POOL, 0, NULL); return res; }
+
+  struct _cmd_batch *batch = get_batch(app, cur_pool, app->cmd_data[cur_pool].submitted + 1);
+
+  /* Nothing recorded, the last submitted batch is the newest */
+  if (!batch->recording) {
+    if (ticket) *ticket = app->cmd_data[cur_pool].submitted;
+    return VK_SUCCESS;
+  }
+
+  res = vkEndCommandBuffer(batch->cmd_buff);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkEndCommandBuffer"); return res; }
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &batch->cmd_buff;
+
+  res = vkQueueSubmit(app->ld_data[app->cmd_data[cur_pool].ldi].graphics, 1, &submit_info, batch->fence);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkQueueSubmit"); return res; }
+
+  batch->recording = false;
+  app->cmd_data[cur_pool].submitted++;
+  if (ticket) *ticket = batch->ticket;
+
+  return res;
+}
+
+bool dlu_exec_batch_done(vkcomp *app, uint32_t cur_pool, uint64_t ticket) {
+  if (!ticket) return true;
+  if (ticket > app->cmd_data[cur_pool].submitted) return false;
+
+  /* The batch's slot was reused, it must have finished first */
+  struct _cmd_batch *batch = get_batch(app, cur_pool, ticket);
+  if (batch->ticket != ticket) return true;
+
+  return vkGetFenceStatus(app->ld_data[app->cmd_data[cur_pool].ldi].device, batch->fence) == VK_SUCCESS;
+}
+
+VkResult dlu_exec_wait_batch(vkcomp *app, uint32_t cur_pool, uint64_t ticket) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!ticket || ticket > app->cmd_data[cur_pool].submitted + 1) return VK_SUCCESS;
+
+  if (ticket == app->cmd_data[cur_pool].submitted + 1) {
+    if (!get_batch(app, cur_pool, ticket)->recording) return VK_SUCCESS;
+    res = dlu_exec_submit_batch(app, cur_pool, NULL);
+    if (res) return res;
+  }
+
+  struct _cmd_batch *batch = get_batch(app, cur_pool, ticket);
+  if (batch->ticket != ticket) return VK_SUCCESS;
+
+  res = vkWaitForFences(app->ld_data[app->cmd_data[cur_pool].ldi].device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences");
+
+  return res;
+}
+
 void dlu_exec_copy_buffer(
   vkcomp *app,
   uint32_t src_bd,
@@ -191,6 +321,9 @@ VkResult dlu_exec_begin_cmd_buffs(
     if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); return res; }
   }
 
+  /* Whatever dlu_exec_record_cached() left in them is gone */
+  dlu_exec_mark_dirty(app, cur_pool);
+
   return res;
 }
 
@@ -207,6 +340,76 @@ VkResult dlu_exec_stop_cmd_buffs(vkcomp *app, uint32_t cur_pool, uint32_t cur_sc
   return res;
 }
 
+VkResult dlu_exec_record_cached(
+  vkcomp *app,
+  uint32_t cur_pool,
+  uint32_t cur_scd,
+  uint32_t cur_gpd,
+  uint32_t cur_img,
+  VkRect2D render_area,
+  uint32_t clearValueCount,
+  const VkClearValue *pClearValues,
+  dlu_exec_record_fn record,
+  void *data,
+  VkCommandBuffer *cmd_buff
+) {
+
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct _cmd_data *cd = &app->cmd_data[cur_pool];
+
+  if (!cd->cmd_buffs || !cd->recorded) { PERR(DLU_VKCOMP_CMD_BUFFS, 0, NULL); return res; }
+
+  /* Re-recording implicitly resets the buffer, which only this pool flag allows */
+  if (!(cd->flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)) {
+    dlu_log_me(DLU_DANGER, "[x] Command pool %u wasn't created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT", cur_pool);
+    return res;
+  }
+
+  if (!app->sc_data[cur_scd].syncs) { PERR(DLU_VKCOMP_SC_SYNCS, 0, NULL); return res; }
+
+  /* The image's previous submission must be done before its buffer is resubmitted or re-recorded */
+  res = vkWaitForFences(app->ld_data[cd->ldi].device, 1, &app->sc_data[cur_scd].syncs[cur_img].fence.render, VK_TRUE, UINT64_MAX);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences"); return res; }
+
+  *cmd_buff = cd->cmd_buffs[cur_img];
+
+  /* Unchanged frames cost only the submit */
+  if (cd->recorded[cur_img] == cd->state + 1) return res;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = 0; /* Replayed, so no VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT */
+  begin_info.pInheritanceInfo = NULL;
+
+  res = vkBeginCommandBuffer(*cmd_buff, &begin_info);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); return res; }
+
+  VkRenderPassBeginInfo render_pass_info = {};
+  render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  render_pass_info.pNext = NULL;
+  render_pass_info.renderPass = app->gp_data[cur_gpd].render_pass;
+  render_pass_info.framebuffer = app->sc_data[cur_scd].sc_buffs[cur_img].fb;
+  render_pass_info.renderArea = render_area;
+  render_pass_info.clearValueCount = clearValueCount;
+  render_pass_info.pClearValues = pClearValues;
+
+  vkCmdBeginRenderPass(*cmd_buff, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+  record(app, cur_pool, cur_img, data);
+  vkCmdEndRenderPass(*cmd_buff);
+
+  res = vkEndCommandBuffer(*cmd_buff);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkEndCommandBuffer"); return res; }
+
+  cd->recorded[cur_img] = cd->state + 1;
+
+  return res;
+}
+
+void dlu_exec_mark_dirty(vkcomp *app, uint32_t cur_pool) {
+  app->cmd_data[cur_pool].state++;
+}
+
 void dlu_exec_cmd_draw(
   vkcomp *app,
   uint32_t cur_pool,
@@ -0,0 +1,305 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+/**
+* cur_pool     | Command pool whose first frame_cnt command buffers belong to the frames
+* cur_ubd      | Uniform ring sliced per frame, UINT32_MAX if there's none
+* frame_cnt    | Frames in flight, size of the fence ring
+* cur          | Frame slot being recorded, or the next one to be
+* img          | Swap chain image acquired for the frame being recorded
+* recording    | Between dlu_vk_frame_begin(3) and dlu_vk_frame_end(3)
+* dev_frame    | Logical device frame this swap chain last ended a frame in
+* image_fences | Render fence of the frame that last rendered to each swap chain image.
+*                An image can be acquired again before the frame using it retired
+* sic          | Size of image_fences, stored after the struct
+*/
+struct _dlu_vk_frames {
+  uint32_t cur_pool;
+  uint32_t cur_ubd;
+  uint32_t frame_cnt;
+  uint32_t cur;
+  uint32_t img;
+  bool recording;
+  uint64_t dev_frame;
+  uint32_t sic;
+  VkFence *image_fences;
+};
+
+VkResult dlu_vk_frame_create(vkcomp *app, uint32_t cur_scd, uint32_t cur_pool, uint32_t frame_cnt, uint32_t cur_ubd) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct _sc_data *sc = &app->sc_data[cur_scd];
+  dlu_vk_frames *fr = NULL;
+
+  if (!sc->syncs) { PERR(DLU_VKCOMP_SC_SYNCS, 0, NULL); return res; }
+  if (!app->cmd_data[cur_pool].cmd_buffs) { PERR(DLU_VKCOMP_CMD_BUFFS, 0, NULL); return res; }
+  if (sc->frames) { dlu_log_me(DLU_DANGER, "[x] Swap chain %u already has a frame engine", cur_scd); return res; }
+  if (!frame_cnt || frame_cnt > sc->sic) {
+    dlu_log_me(DLU_DANGER, "[x] Frames in flight must be between 1 and the swap chain image count (%u), got %u", sc->sic, frame_cnt);
+    return res;
+  }
+
+  /* Every frame in flight writes its own slice of the ring */
+  if (cur_ubd != UINT32_MAX && app->buff_data[cur_ubd].ring.frame_cnt < frame_cnt) {
+    dlu_log_me(DLU_DANGER, "[x] Uniform ring %u has %u slices, %u frames in flight need one each", cur_ubd, app->buff_data[cur_ubd].ring.frame_cnt, frame_cnt);
+    return res;
+  }
+
+  fr = calloc(1, sizeof(dlu_vk_frames) + (sc->sic * sizeof(VkFence)));
+  if (!fr) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+
+  fr->image_fences = (VkFence *) (fr + 1);
+  fr->cur_pool = cur_pool;
+  fr->cur_ubd = cur_ubd;
+  fr->frame_cnt = frame_cnt;
+  fr->sic = sc->sic;
+  fr->dev_frame = UINT64_MAX;
+  sc->frames = fr;
+  app->ld_data[sc->ldi].engines++;
+
+  /**
+  * A texture stamped in a frame is only known to be idle once that frame's fence
+  * was waited on, frame_cnt frames later. One more covers evicting between frames.
+  */
+  if (app->ld_data[sc->ldi].evict_lag < (frame_cnt + 1))
+    app->ld_data[sc->ldi].evict_lag = frame_cnt + 1;
+
+  return VK_SUCCESS;
+}
+
+VkResult dlu_vk_frame_wait_idle(vkcomp *app, uint32_t cur_scd) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_frames *fr = app->sc_data[cur_scd].frames;
+
+  if (!fr) { PERR(DLU_VKCOMP_FRAMES, 0, NULL); return res; }
+
+  VkFence *fences = alloca(fr->frame_cnt * sizeof(VkFence));
+  for (uint32_t i = 0; i < fr->frame_cnt; i++)
+    fences[i] = app->sc_data[cur_scd].syncs[i].fence.render;
+
+  res = vkWaitForFences(app->ld_data[app->sc_data[cur_scd].ldi].device, fr->frame_cnt, fences, VK_TRUE, UINT64_MAX);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences");
+
+  /* Every image is free, fences of old swap chain images mustn't be waited on */
+  memset(fr->image_fences, 0, fr->sic * sizeof(VkFence));
+
+  return res;
+}
+
+/**
+* Frame that won't be submitted. Its acquire semaphore is still waited on so the next acquire
+* can signal it again. fence is signaled along with it unless it's VK_NULL_HANDLE.
+*/
+static void drop_frame(vkcomp *app, struct _sc_data *sc, VkSemaphore sem, VkFence fence) {
+  VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.waitSemaphoreCount = 1;
+  submit_info.pWaitSemaphores = &sem;
+  submit_info.pWaitDstStageMask = &wait_stage;
+
+  VkResult res = vkQueueSubmit(app->ld_data[sc->ldi].graphics, 1, &submit_info, fence);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkQueueSubmit");
+}
+
+/**
+* Textures are stamped with the logical device frame. With several swap chains on one
+* device it only advances once each of them ended a frame, the slowest one sets the pace.
+*/
+static void end_device_frame(vkcomp *app, uint32_t cur_ld, dlu_vk_frames *fr) {
+  struct _ld_data *ld = &app->ld_data[cur_ld];
+
+  if (fr->dev_frame == ld->frame) return;
+  fr->dev_frame = ld->frame;
+
+  if (++ld->ended < ld->engines) return;
+  ld->ended = 0;
+  dlu_vk_mem_next_frame(app, cur_ld);
+}
+
+void dlu_vk_frame_destroy(vkcomp *app, uint32_t cur_scd) {
+  struct _sc_data *sc = &app->sc_data[cur_scd];
+  dlu_vk_frames *fr = sc->frames;
+  if (!fr) return;
+
+  /* A frame begun but never ended still holds its acquire semaphore */
+  if (fr->recording) drop_frame(app, sc, sc->syncs[fr->cur].sem.image, VK_NULL_HANDLE);
+  dlu_vk_frame_wait_idle(app, cur_scd);
+
+  /* Other swap chains mustn't wait on this one to end the device frame */
+  struct _ld_data *ld = &app->ld_data[sc->ldi];
+  if (fr->dev_frame == ld->frame) ld->ended--;
+  ld->engines--;
+  if (ld->engines && ld->ended >= ld->engines) {
+    ld->ended = 0;
+    dlu_vk_mem_next_frame(app, sc->ldi);
+  }
+
+  free(fr);
+  sc->frames = NULL;
+}
+
+VkResult dlu_vk_frame_begin(vkcomp *app, uint32_t cur_scd, uint32_t *cur_buff, uint32_t *cur_img) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct _sc_data *sc = &app->sc_data[cur_scd];
+  dlu_vk_frames *fr = sc->frames;
+
+  if (!fr) { PERR(DLU_VKCOMP_FRAMES, 0, NULL); return res; }
+  if (fr->recording) { dlu_log_me(DLU_DANGER, "[x] Frame %u is still being recorded, call dlu_vk_frame_end()", fr->cur); return res; }
+
+  VkDevice device = app->ld_data[sc->ldi].device;
+  VkFence fence = sc->syncs[fr->cur].fence.render;
+  VkCommandBuffer cmd_buff = app->cmd_data[fr->cur_pool].cmd_buffs[fr->cur];
+
+  /* Only CPU wait of the loop, on the frame submitted frame_cnt frames ago */
+  res = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences"); return res; }
+
+  /* The GPU is done with the frame that last wrote this slot's ring slice */
+  if (fr->cur_ubd != UINT32_MAX) {
+    res = dlu_uniform_ring_begin(app, fr->cur_ubd, fr->cur);
+    if (res) return res;
+  }
+
+  res = dlu_acquire_sc_image_index(app, cur_scd, fr->cur, &fr->img);
+  if (res && res != VK_SUBOPTIMAL_KHR) return res;
+
+  /* Images aren't acquired in order, the one handed out may still be rendered to by another slot */
+  if (fr->image_fences[fr->img] && fr->image_fences[fr->img] != fence) {
+    res = vkWaitForFences(device, 1, &fr->image_fences[fr->img], VK_TRUE, UINT64_MAX);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences"); goto err_drop; }
+  }
+  fr->image_fences[fr->img] = fence;
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  begin_info.pInheritanceInfo = NULL;
+
+  /* Implicitly resets the command buffer, the pool has VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT */
+  res = vkBeginCommandBuffer(cmd_buff, &begin_info);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); goto err_drop; }
+
+  fr->recording = true;
+  *cur_buff = fr->cur;
+  *cur_img = fr->img;
+
+  return res;
+
+err_drop:
+  /* Fence is left signaled, the next dlu_vk_frame_begin(3) reuses this slot */
+  drop_frame(app, sc, sc->syncs[fr->cur].sem.image, VK_NULL_HANDLE);
+  return res;
+}
+
+void dlu_vk_frame_begin_render_pass(
+  vkcomp *app,
+  uint32_t cur_scd,
+  uint32_t cur_gpd,
+  VkRect2D render_area,
+  uint32_t clearValueCount,
+  const VkClearValue *pClearValues,
+  VkSubpassContents contents
+) {
+
+  dlu_vk_frames *fr = app->sc_data[cur_scd].frames;
+  if (!fr || !fr->recording) { PERR(DLU_VKCOMP_FRAMES, 0, NULL); return; }
+
+  VkRenderPassBeginInfo render_pass_info = {};
+  render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  render_pass_info.pNext = NULL;
+  render_pass_info.renderPass = app->gp_data[cur_gpd].render_pass;
+  render_pass_info.framebuffer = app->sc_data[cur_scd].sc_buffs[fr->img].fb;
+  render_pass_info.renderArea = render_area;
+  render_pass_info.clearValueCount = clearValueCount;
+  render_pass_info.pClearValues = pClearValues;
+
+  vkCmdBeginRenderPass(app->cmd_data[fr->cur_pool].cmd_buffs[fr->cur], &render_pass_info, contents);
+}
+
+void dlu_vk_frame_stop_render_pass(vkcomp *app, uint32_t cur_scd) {
+  dlu_vk_frames *fr = app->sc_data[cur_scd].frames;
+  if (!fr || !fr->recording) { PERR(DLU_VKCOMP_FRAMES, 0, NULL); return; }
+
+  vkCmdEndRenderPass(app->cmd_data[fr->cur_pool].cmd_buffs[fr->cur]);
+}
+
+VkResult dlu_vk_frame_end(vkcomp *app, uint32_t cur_scd) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  struct _sc_data *sc = &app->sc_data[cur_scd];
+  dlu_vk_frames *fr = sc->frames;
+
+  if (!fr || !fr->recording) { PERR(DLU_VKCOMP_FRAMES, 0, NULL); return res; }
+
+  VkDevice device = app->ld_data[sc->ldi].device;
+  VkFence fence = sc->syncs[fr->cur].fence.render;
+  VkCommandBuffer cmd_buff = app->cmd_data[fr->cur_pool].cmd_buffs[fr->cur];
+
+  /* Color output waits for the image to be acquired, anything before it can already run */
+  VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  VkSemaphore acquire_sem = sc->syncs[fr->cur].sem.image;
+  VkSemaphore render_sem = sc->syncs[fr->img].sem.render;
+  uint32_t img = fr->img;
+
+  /* Whatever happens the frame is over, a failed one leaves its fence signaled */
+  fr->recording = false;
+
+  res = vkEndCommandBuffer(cmd_buff);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkEndCommandBuffer"); goto err_drop; }
+
+  if (fr->cur_ubd != UINT32_MAX) {
+    res = dlu_uniform_ring_end(app, fr->cur_ubd);
+    if (res) goto err_drop;
+  }
+
+  /* Reset right before the submit that signals it again, else the next wait never returns */
+  res = vkResetFences(device, 1, &fence);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkResetFences"); goto err_drop; }
+
+  res = dlu_queue_graphics_queue(app, cur_scd, fr->cur, 1, &cmd_buff, 1, &acquire_sem, &wait_stage, 1, &render_sem);
+  if (res) {
+    /* A failed submit leaves the fence and semaphore untouched, signal the fence without the frame */
+    drop_frame(app, sc, acquire_sem, fence);
+    return res;
+  }
+
+  fr->cur = (fr->cur + 1) % fr->frame_cnt;
+
+  /* Textures used by this frame are stamped with it, see dlu_vk_touch_texture(3) */
+  end_device_frame(app, sc->ldi, fr);
+
+  res = dlu_queue_present_queue(app, sc->ldi, 1, &render_sem, 1, &sc->swap_chain, &img, NULL);
+  if (res == VK_SUBOPTIMAL_KHR) res = VK_SUCCESS;
+
+  return res;
+
+err_drop:
+  drop_frame(app, sc, acquire_sem, VK_NULL_HANDLE);
+  return res;
+}
@@ -0,0 +1,543 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+/* Smallest range handed out is 1 << MIN_SHIFT bytes (order 0) */
+#define MIN_SHIFT 8
+
+/* Orders from MIN_SHIFT up to a whole DLU_VK_MEM_BLOCK_SIZE block */
+#define ORDER_CNT (DLU_VK_MEM_BLOCK_SHIFT - MIN_SHIFT + 1)
+
+/**
+* A VkDeviceMemory object split with a buddy allocator
+* mem       | The VkDeviceMemory object
+* type_idx  | Memory type the block was allocated from
+* heap      | Memory heap of type_idx
+* linear    | Holds linear resources (true) or optimal tiling images (false)
+* map       | Host address of the whole block, NULL unless the memory type is host visible
+* free      | Bytes not handed out
+* free_cnt  | Amount of free ranges in each order, avoids scanning empty orders
+* bits      | One bit per range of each order, set when the range is free
+*/
+struct _dlu_vk_mem_block {
+  VkDeviceMemory mem;
+  uint32_t type_idx;
+  uint32_t heap;
+  bool linear;
+  void *map;
+  VkDeviceSize free;
+  uint32_t free_cnt[ORDER_CNT];
+  uint64_t *bits[ORDER_CNT];
+  struct _dlu_vk_mem_block *next;
+};
+
+static uint32_t range_cnt(uint32_t order) {
+  return DLU_VK_MEM_BLOCK_SIZE >> (MIN_SHIFT + order);
+}
+
+static void set_bit(dlu_vk_mem_block *block, uint32_t order, uint64_t idx, bool free) {
+  if (free) {
+    block->bits[order][idx >> 6] |= (1UL << (idx & 63));
+    block->free_cnt[order]++;
+  } else {
+    block->bits[order][idx >> 6] &= ~(1UL << (idx & 63));
+    block->free_cnt[order]--;
+  }
+}
+
+static bool get_bit(dlu_vk_mem_block *block, uint32_t order, uint64_t idx) {
+  return block->bits[order][idx >> 6] & (1UL << (idx & 63));
+}
+
+/* Order of the smallest range that fits size bytes aligned to align */
+static uint32_t get_order(VkDeviceSize size, VkDeviceSize align) {
+  if (size < align) size = align;
+
+  uint32_t order = 0;
+  while (((VkDeviceSize) 1 << (MIN_SHIFT + order)) < size) order++;
+
+  return order;
+}
+
+/**
+* Look up a memory type's heap and whether it's host visible. Returns the device's nonCoherentAtomSize
+* if it's host visible but not host coherent, flushes and invalidates are aligned to it.
+*/
+static VkDeviceSize get_atom(vkcomp *app, uint32_t pdi, uint32_t type_idx, VkMemoryPropertyFlags *flags, uint32_t *heap) {
+  VkPhysicalDeviceMemoryProperties memory_properties;
+  VkPhysicalDeviceProperties device_props;
+
+  vkGetPhysicalDeviceMemoryProperties(app->pd_data[pdi].phys_dev, &memory_properties);
+  *flags = memory_properties.memoryTypes[type_idx].propertyFlags;
+  *heap = memory_properties.memoryTypes[type_idx].heapIndex;
+
+  if (!(*flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) || (*flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) return 0;
+
+  vkGetPhysicalDeviceProperties(app->pd_data[pdi].phys_dev, &device_props);
+  return device_props.limits.nonCoherentAtomSize;
+}
+
+/**
+* Host visible memory is mapped once for its whole lifetime. vkFreeMemory
+* implicitly unmaps it, so there's never a matching vkUnmapMemory call.
+*/
+static VkResult map_whole(VkDevice device, VkDeviceMemory mem, bool host_visible, void **map) {
+  *map = NULL;
+  if (!host_visible) return VK_SUCCESS;
+
+  VkResult res = vkMapMemory(device, mem, 0, VK_WHOLE_SIZE, 0, map);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkMapMemory");
+
+  return res;
+}
+
+static dlu_vk_mem_block *create_block(vkcomp *app, VkDevice device, uint32_t type_idx, bool linear, bool host_visible, bool bda) {
+  dlu_vk_mem_block *block = NULL;
+  uint64_t *bits = NULL;
+  size_t words = 0;
+
+  /* Bitmaps are stored right after the block */
+  for (uint32_t i = 0; i < ORDER_CNT; i++)
+    words += (range_cnt(i) + 63) >> 6;
+
+  block = calloc(1, sizeof(dlu_vk_mem_block) + (words * sizeof(uint64_t)));
+  if (!block) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return NULL; }
+
+  /* With buffer device address enabled any buffer may be bound to the block */
+  VkMemoryAllocateFlagsInfo flags_info = {};
+  flags_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+  flags_info.pNext = NULL;
+  flags_info.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+  VkMemoryAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  alloc_info.pNext = (bda) ? &flags_info : NULL;
+  alloc_info.allocationSize = DLU_VK_MEM_BLOCK_SIZE;
+  alloc_info.memoryTypeIndex = type_idx;
+
+  VkResult res = vkAllocateMemory(device, &alloc_info, app->vk_alloc, &block->mem);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateMemory"); free(block); return NULL; }
+
+  if (map_whole(device, block->mem, host_visible, &block->map)) {
+    vkFreeMemory(device, block->mem, app->vk_alloc);
+    free(block); return NULL;
+  }
+
+  bits = (uint64_t *) (block + 1);
+  for (uint32_t i = 0; i < ORDER_CNT; i++) {
+    block->bits[i] = bits;
+    bits += (range_cnt(i) + 63) >> 6;
+  }
+
+  block->type_idx = type_idx;
+  block->linear = linear;
+  block->free = DLU_VK_MEM_BLOCK_SIZE;
+
+  /* The whole block is a single free range of the highest order */
+  set_bit(block, ORDER_CNT - 1, 0, true);
+
+  return block;
+}
+
+/**
+* Take the first free range of the smallest order >= order that has one,
+* splitting it down to the requested order. The right halves stay free.
+*/
+static bool block_alloc(dlu_vk_mem_block *block, uint32_t order, VkDeviceSize *offset) {
+  uint32_t j = order;
+  uint64_t idx = 0;
+
+  while (j < ORDER_CNT && !block->free_cnt[j]) j++;
+  if (j == ORDER_CNT) return false;
+
+  for (uint32_t w = 0; ; w++) {
+    if (block->bits[j][w]) {
+      idx = (w << 6) + __builtin_ctzl(block->bits[j][w]);
+      break;
+    }
+  }
+
+  set_bit(block, j, idx, false);
+  while (j > order) {
+    j--; idx <<= 1;
+    set_bit(block, j, idx + 1, true);
+  }
+
+  block->free -= (VkDeviceSize) 1 << (MIN_SHIFT + order);
+  *offset = idx << (MIN_SHIFT + order);
+
+  return true;
+}
+
+/* Merge a released range with its buddy for as long as the buddy is free */
+static void block_free(dlu_vk_mem_block *block, uint32_t order, VkDeviceSize offset) {
+  uint64_t idx = offset >> (MIN_SHIFT + order);
+  block->free += (VkDeviceSize) 1 << (MIN_SHIFT + order);
+
+  while (order < (ORDER_CNT - 1) && get_bit(block, order, idx ^ 1)) {
+    set_bit(block, order, idx ^ 1, false);
+    idx >>= 1; order++;
+  }
+
+  set_bit(block, order, idx, true);
+}
+
+VkResult dlu_vk_mem_get_budget(vkcomp *app, uint32_t cur_ld, uint32_t heap, VkDeviceSize *usage, VkDeviceSize *budget) {
+  VkPhysicalDevice phys_dev = app->pd_data[app->ld_data[cur_ld].pdi].phys_dev;
+  VkPhysicalDeviceMemoryProperties memory_properties;
+
+  vkGetPhysicalDeviceMemoryProperties(phys_dev, &memory_properties);
+  if (heap >= memory_properties.memoryHeapCount) {
+    dlu_log_me(DLU_DANGER, "[x] Memory heap %u doesn't exist, the device has %u", heap, memory_properties.memoryHeapCount);
+    return VK_RESULT_MAX_ENUM;
+  }
+
+  if (app->ld_data[cur_ld].budget_ext) {
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_props = {};
+    budget_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    budget_props.pNext = NULL;
+
+    VkPhysicalDeviceMemoryProperties2 props2 = {};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    props2.pNext = &budget_props;
+
+    app->get_mem_props2(phys_dev, &props2);
+    *usage = budget_props.heapUsage[heap];
+    *budget = budget_props.heapBudget[heap];
+  } else {
+    /* Without the extension only vkcomp's own allocations are known, leave room for everyone else */
+    *usage = app->ld_data[cur_ld].heap_usage[heap];
+    *budget = (memory_properties.memoryHeaps[heap].size / 100) * DLU_VK_MEM_BUDGET_PERCENT;
+  }
+
+  if (app->ld_data[cur_ld].budget_cap && *budget > app->ld_data[cur_ld].budget_cap)
+    *budget = app->ld_data[cur_ld].budget_cap;
+
+  return VK_SUCCESS;
+}
+
+void dlu_vk_mem_set_budget(vkcomp *app, uint32_t cur_ld, VkDeviceSize budget) {
+  app->ld_data[cur_ld].budget_cap = budget;
+}
+
+void dlu_vk_mem_set_evict_hook(vkcomp *app, uint32_t cur_ld, dlu_vk_evict_hook evict, void *data) {
+  app->ld_data[cur_ld].evict = evict;
+  app->ld_data[cur_ld].evict_data = data;
+}
+
+void dlu_vk_mem_next_frame(vkcomp *app, uint32_t cur_ld) {
+  app->ld_data[cur_ld].frame++;
+}
+
+void dlu_vk_touch_texture(vkcomp *app, uint32_t cur_tex) {
+  app->text_data[cur_tex].last_use = app->ld_data[app->text_data[cur_tex].ldi].frame;
+  app->text_data[cur_tex].evictable = true;
+}
+
+void dlu_vk_texture_set_evictable(vkcomp *app, uint32_t cur_tex, bool evictable) {
+  app->text_data[cur_tex].evictable = evictable;
+}
+
+bool dlu_vk_texture_evicted(vkcomp *app, uint32_t cur_tex) {
+  return app->text_data[cur_tex].evicted;
+}
+
+/**
+* Whether evicting cur_tex makes room for the allocation: its memory is given back outright,
+* or its range is big enough and in a block the allocation can be sub-allocated from
+*/
+static bool makes_room(vkcomp *app, uint32_t cur_tex, uint32_t type_idx, bool linear, VkDeviceSize size) {
+  dlu_vk_suballoc *sub = &app->text_data[cur_tex].sub;
+
+  if (!sub->block) return true;
+  if ((sub->block->free + sub->size) == DLU_VK_MEM_BLOCK_SIZE) return true;
+
+  return type_idx != UINT32_MAX && sub->block->type_idx == type_idx && sub->block->linear == linear && sub->size >= size;
+}
+
+bool dlu_vk_evict_lru_texture(vkcomp *app, uint32_t cur_ld, uint32_t heap, uint32_t type_idx, bool linear, VkDeviceSize size, void *data) {
+  uint64_t frame = app->ld_data[cur_ld].frame;
+  uint32_t lag = (app->ld_data[cur_ld].evict_lag) ? app->ld_data[cur_ld].evict_lag : DLU_VK_EVICT_FRAME_LAG;
+  uint32_t lru = UINT32_MAX;
+
+  (void) data;
+
+  /* Textures used within the last lag frames may still be read by the GPU */
+  for (uint32_t i = 0; i < app->tdc; i++) {
+    if (app->text_data[i].ldi != cur_ld || !app->text_data[i].mem || app->text_data[i].sub.heap != heap) continue;
+    if (!app->text_data[i].evictable || (app->text_data[i].last_use + lag) > frame) continue;
+    if (!makes_room(app, i, type_idx, linear, size) || dlu_vk_bindless_is_fallback(app, cur_ld, i)) continue;
+    if (lru == UINT32_MAX || app->text_data[i].last_use < app->text_data[lru].last_use) lru = i;
+  }
+
+  if (lru == UINT32_MAX) return false;
+
+  dlu_log_me(DLU_WARNING, "Memory heap %u is over budget, evicting texture %u (last used in frame %lu)", heap, lru, app->text_data[lru].last_use);
+
+  /* Bindless slots mustn't keep pointing at the view */
+  dlu_vk_bindless_evict_texture(app, cur_ld, lru);
+
+  /* The sampler is kept, the image has to be recreated and uploaded again before its next use */
+  VkDevice device = app->ld_data[cur_ld].device;
+  if (app->text_data[lru].view) vkDestroyImageView(device, app->text_data[lru].view, app->vk_alloc);
+  if (app->text_data[lru].image) vkDestroyImage(device, app->text_data[lru].image, app->vk_alloc);
+  dlu_vk_mem_free(app, cur_ld, app->text_data[lru].mem, &app->text_data[lru].sub);
+
+  app->text_data[lru].view = VK_NULL_HANDLE;
+  app->text_data[lru].image = VK_NULL_HANDLE;
+  app->text_data[lru].mem = VK_NULL_HANDLE;
+  app->text_data[lru].last_use = 0;
+  app->text_data[lru].evictable = false;
+  app->text_data[lru].evicted = true;
+
+  return true;
+}
+
+static bool over_budget(vkcomp *app, uint32_t cur_ld, uint32_t heap, VkDeviceSize size) {
+  VkDeviceSize usage = 0, budget = 0;
+  if (dlu_vk_mem_get_budget(app, cur_ld, heap, &usage, &budget)) return false;
+  return (usage + size) > budget;
+}
+
+/* Give back blocks of a heap that have nothing handed out */
+static bool release_empty_blocks(vkcomp *app, uint32_t cur_ld, uint32_t heap) {
+  dlu_vk_mem_block **link = &app->ld_data[cur_ld].mem_blocks, *block = NULL;
+  bool released = false;
+
+  while ((block = *link)) {
+    if (block->heap != heap || block->free != DLU_VK_MEM_BLOCK_SIZE) { link = &block->next; continue; }
+
+    *link = block->next;
+    vkFreeMemory(app->ld_data[cur_ld].device, block->mem, app->vk_alloc);
+    app->ld_data[cur_ld].heap_usage[heap] -= DLU_VK_MEM_BLOCK_SIZE;
+    free(block);
+    released = true;
+  }
+
+  return released;
+}
+
+/* Run the eviction policy once, returns false when it has nothing left to evict */
+static bool evict(vkcomp *app, uint32_t cur_ld, uint32_t heap, uint32_t type_idx, bool linear, VkDeviceSize size) {
+  dlu_vk_evict_hook hook = app->ld_data[cur_ld].evict;
+  if (!hook) hook = dlu_vk_evict_lru_texture;
+  return hook(app, cur_ld, heap, type_idx, linear, size, app->ld_data[cur_ld].evict_data);
+}
+
+VkResult dlu_vk_mem_alloc(
+  vkcomp *app,
+  uint32_t cur_ld,
+  VkMemoryRequirements *mem_reqs,
+  VkMemoryPropertyFlags requirements_mask,
+  bool linear,
+  VkDeviceMemory *mem,
+  dlu_vk_suballoc *sub
+) {
+
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_mem_block *block = NULL;
+  VkDevice device = app->ld_data[cur_ld].device;
+  uint32_t type_idx = 0, order = 0, heap = 0;
+  VkDeviceSize atom = 0, need = 0;
+  VkMemoryPropertyFlags flags = 0;
+  bool host_visible = false, pooled = false;
+
+  /* find a suitable memory type */
+  if (!memory_type_from_properties(app, app->ld_data[cur_ld].pdi, mem_reqs->memoryTypeBits, requirements_mask, &type_idx)) {
+    PERR(DLU_MEM_TYPE_ERR, 0, NULL);
+    return res;
+  }
+
+  /**
+  * Ranges of non-coherent memory start and end on an atom boundary. Rounding a
+  * flush or invalidate out to the atom then never touches a neighbouring resource.
+  */
+  atom = get_atom(app, app->ld_data[cur_ld].pdi, type_idx, &flags, &heap);
+  order = get_order(mem_reqs->size, (mem_reqs->alignment > atom) ? mem_reqs->alignment : atom);
+  host_visible = flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+  /**
+  * Large resources aren't worth splitting a block for. Lazily allocated memory backs
+  * transient attachments, each gets its own object so the driver commits pages per attachment
+  */
+  pooled = (order < (ORDER_CNT - 1)) && !(flags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+  need = (pooled) ? DLU_VK_MEM_BLOCK_SIZE : mem_reqs->size;
+
+  /* Heap usage before the last eviction, VK_WHOLE_SIZE if nothing was evicted since memory was last given back */
+  VkDeviceSize usage = VK_WHOLE_SIZE;
+
+  for (;;) {
+    for (block = app->ld_data[cur_ld].mem_blocks; pooled && block; block = block->next) {
+      if (block->type_idx != type_idx || block->linear != linear) continue;
+      if (block_alloc(block, order, &sub->offset)) goto pooled_alloc;
+    }
+
+    /* New memory is needed, make room for it first if the heap's budget would be exceeded */
+    if (!over_budget(app, cur_ld, heap, need)) break;
+    if (release_empty_blocks(app, cur_ld, heap)) { usage = VK_WHOLE_SIZE; continue; }
+
+    /* The last eviction neither made room in a block nor gave memory back, more of them won't either */
+    if (usage != VK_WHOLE_SIZE && app->ld_data[cur_ld].heap_usage[heap] >= usage) {
+      dlu_log_me(DLU_WARNING, "Memory heap %u is over budget and evicting doesn't make room, allocating anyway", heap);
+      break;
+    }
+
+    usage = app->ld_data[cur_ld].heap_usage[heap];
+    if (!evict(app, cur_ld, heap, (pooled) ? type_idx : UINT32_MAX, linear, (pooled) ? (VkDeviceSize) 1 << (MIN_SHIFT + order) : need)) {
+      dlu_log_me(DLU_WARNING, "Memory heap %u is over budget and nothing can be evicted, allocating anyway", heap);
+      break;
+    }
+  }
+
+  /* Every block of the type is full, fall back to a dedicated allocation if a new one can't be made */
+  if (!pooled) goto dedicated_alloc;
+  block = create_block(app, device, type_idx, linear, host_visible, app->ld_data[cur_ld].bda);
+  if (!block) goto dedicated_alloc;
+
+  block->heap = heap;
+  block->next = app->ld_data[cur_ld].mem_blocks;
+  app->ld_data[cur_ld].mem_blocks = block;
+  app->ld_data[cur_ld].heap_usage[heap] += DLU_VK_MEM_BLOCK_SIZE;
+  block_alloc(block, order, &sub->offset);
+
+pooled_alloc:
+  *mem = block->mem;
+  sub->size = (VkDeviceSize) 1 << (MIN_SHIFT + order);
+  sub->block = block;
+  sub->atom = atom;
+  sub->heap = heap;
+  sub->map = (block->map) ? (char *) block->map + sub->offset : NULL;
+  return VK_SUCCESS;
+
+dedicated_alloc:
+  {
+    VkMemoryAllocateFlagsInfo flags_info = {};
+    flags_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+    flags_info.pNext = NULL;
+    flags_info.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.pNext = (app->ld_data[cur_ld].bda) ? &flags_info : NULL;
+    alloc_info.allocationSize = mem_reqs->size;
+    alloc_info.memoryTypeIndex = type_idx;
+
+    /**
+    * The budget may be off, the driver has the last word. Keep evicting while it's out of memory,
+    * only whole VkDeviceMemory objects given back help here
+    */
+    while ((res = vkAllocateMemory(device, &alloc_info, app->vk_alloc, mem)) == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+      if (release_empty_blocks(app, cur_ld, heap)) continue;
+      usage = app->ld_data[cur_ld].heap_usage[heap];
+      if (!evict(app, cur_ld, heap, UINT32_MAX, linear, mem_reqs->size)) break;
+      if (!release_empty_blocks(app, cur_ld, heap) && app->ld_data[cur_ld].heap_usage[heap] >= usage) break;
+    }
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateMemory"); return res; }
+
+    res = map_whole(device, *mem, host_visible, &sub->map);
+    if (res) { vkFreeMemory(device, *mem, app->vk_alloc); *mem = VK_NULL_HANDLE; return res; }
+
+    app->ld_data[cur_ld].heap_usage[heap] += mem_reqs->size;
+
+    sub->offset = 0;
+    sub->size = mem_reqs->size;
+    sub->block = NULL;
+    sub->atom = atom;
+    sub->heap = heap;
+  }
+
+  return res;
+}
+
+void dlu_vk_mem_free(vkcomp *app, uint32_t cur_ld, VkDeviceMemory mem, dlu_vk_suballoc *sub) {
+  if (!mem) return;
+
+  if (!sub->block) {
+    vkFreeMemory(app->ld_data[cur_ld].device, mem, app->vk_alloc);
+    app->ld_data[cur_ld].heap_usage[sub->heap] -= sub->size;
+  } else {
+    block_free(sub->block, get_order(sub->size, 0), sub->offset);
+  }
+
+  sub->offset = sub->size = sub->atom = 0;
+  sub->heap = 0;
+  sub->block = NULL;
+  sub->map = NULL;
+}
+
+void dlu_vk_mem_pool_destroy(vkcomp *app, uint32_t cur_ld) {
+  dlu_vk_mem_block *block = app->ld_data[cur_ld].mem_blocks, *next = NULL;
+
+  while (block) {
+    next = block->next;
+    vkFreeMemory(app->ld_data[cur_ld].device, block->mem, app->vk_alloc);
+    app->ld_data[cur_ld].heap_usage[block->heap] -= DLU_VK_MEM_BLOCK_SIZE;
+    free(block);
+    block = next;
+  }
+
+  app->ld_data[cur_ld].mem_blocks = NULL;
+}
+
+VkResult dlu_vk_mem_sync(VkDevice device, VkDeviceMemory mem, dlu_vk_suballoc *sub, VkDeviceSize offset, VkDeviceSize size, bool flush) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDeviceSize start = 0, end = 0;
+
+  /* Host coherent memory never needs flushing or invalidating */
+  if (!sub->atom) return VK_SUCCESS;
+
+  /* Round the dirty range out to nonCoherentAtomSize, pool ranges are atom aligned */
+  start = sub->offset + offset;
+  end = (size == VK_WHOLE_SIZE) ? sub->offset + sub->size : start + size;
+  start &= ~(sub->atom - 1);
+  end = (end + sub->atom - 1) & ~(sub->atom - 1);
+
+  VkMappedMemoryRange range = {};
+  range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.pNext = NULL;
+  range.memory = mem;
+  range.offset = start;
+  range.size = end - start;
+
+  /* A dedicated allocation's size needn't be an atom multiple, its tail is reached with VK_WHOLE_SIZE */
+  if (!sub->block && end >= sub->size) range.size = VK_WHOLE_SIZE;
+
+  if (flush) {
+    res = vkFlushMappedMemoryRanges(device, 1, &range);
+    if (res) PERR(DLU_VK_FUNC_ERR, res, "vkFlushMappedMemoryRanges");
+  } else {
+    res = vkInvalidateMappedMemoryRanges(device, 1, &range);
+    if (res) PERR(DLU_VK_FUNC_ERR, res, "vkInvalidateMappedMemoryRanges");
+  }
+
+  return res;
+}
+
+bool dlu_vk_mem_is_pooled(vkcomp *app, uint32_t cur_ld, VkDeviceMemory mem) {
+  for (dlu_vk_mem_block *block = app->ld_data[cur_ld].mem_blocks; block; block = block->next)
+    if (block->mem == mem) return true;
+  return false;
+}
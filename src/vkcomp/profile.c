@@ -0,0 +1,267 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+/**
+* window  | Milliseconds of the scope's last DLU_VK_PROFILE_WINDOW frames, ring starting at head
+* dropped | Samples whose timestamps weren't available when read back
+*/
+struct profile_scope {
+  char *name;
+  double window[DLU_VK_PROFILE_WINDOW];
+  uint32_t head;
+  uint32_t samples;
+  uint64_t dropped;
+};
+
+/**
+* period    | Nanoseconds per timestamp tick (timestampPeriod)
+* mask      | Valid bits of the graphics queue family's timestamps
+* frame     | Frames started, the frame being recorded uses slice (frame - 1) % frame_lag
+* counts    | Scopes each slice holds, a slice's queries start at slice * max_queries * 2
+* owners    | Scope of each query pair
+* results   | Read back buffer, a value and an availability word per query
+* sums      | Milliseconds of each scope in the frame being read back, seen marks the ones it had
+*/
+struct _dlu_vk_profiler {
+  VkQueryPool pool;
+  double period;
+  uint64_t mask;
+  uint32_t max_scopes;
+  uint32_t max_queries;
+  uint32_t frame_lag;
+  uint32_t scope_cnt;
+  uint64_t frame;
+  struct profile_scope *scopes;
+  uint64_t *results;
+  double *sums;
+  uint32_t *counts;
+  uint32_t *owners;
+  bool *seen;
+};
+
+VkResult dlu_vk_profiler_create(vkcomp *app, uint32_t cur_ld, uint32_t max_scopes, uint32_t max_queries, uint32_t frame_lag) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = app->ld_data[cur_ld].device;
+  dlu_vk_profiler *prof = NULL;
+
+  if (!device) { PERR(DLU_VKCOMP_DEVICE, 0, NULL); return res; }
+  if (app->ld_data[cur_ld].profiler) { dlu_log_me(DLU_DANGER, "[x] Logical device %u already has a profiler", cur_ld); return res; }
+  if (!max_scopes || !max_queries || !frame_lag) { dlu_log_me(DLU_DANGER, "[x] A profiler needs at least one scope, query and frame"); return res; }
+
+  struct _pd_data *pd = &app->pd_data[app->ld_data[cur_ld].pdi];
+
+  uint32_t fam_cnt = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(pd->phys_dev, &fam_cnt, NULL);
+  VkQueueFamilyProperties *fams = alloca(fam_cnt * sizeof(VkQueueFamilyProperties));
+  vkGetPhysicalDeviceQueueFamilyProperties(pd->phys_dev, &fam_cnt, fams);
+
+  uint32_t valid_bits = (pd->gfam_idx < fam_cnt) ? fams[pd->gfam_idx].timestampValidBits : 0;
+  if (!valid_bits) { dlu_log_me(DLU_DANGER, "[x] The graphics queue family doesn't support timestamps"); return res; }
+
+  VkPhysicalDeviceProperties device_props;
+  vkGetPhysicalDeviceProperties(pd->phys_dev, &device_props);
+
+  size_t pair_cnt = (size_t) frame_lag * max_queries;
+  size_t size = sizeof(dlu_vk_profiler) + (max_scopes * sizeof(struct profile_scope)) + (max_queries * 4 * sizeof(uint64_t))
+              + (max_scopes * sizeof(double)) + (frame_lag * sizeof(uint32_t)) + (pair_cnt * sizeof(uint32_t)) + (max_scopes * sizeof(bool));
+
+  prof = calloc(1, size);
+  if (!prof) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+
+  /* 8 byte members first */
+  prof->scopes = (struct profile_scope *) (prof + 1);
+  prof->results = (uint64_t *) (prof->scopes + max_scopes);
+  prof->sums = (double *) (prof->results + (max_queries * 4));
+  prof->counts = (uint32_t *) (prof->sums + max_scopes);
+  prof->owners = prof->counts + frame_lag;
+  prof->seen = (bool *) (prof->owners + pair_cnt);
+
+  prof->period = device_props.limits.timestampPeriod;
+  prof->mask = (valid_bits >= 64) ? UINT64_MAX : ((1ULL << valid_bits) - 1);
+  prof->max_scopes = max_scopes;
+  prof->max_queries = max_queries;
+  prof->frame_lag = frame_lag;
+
+  VkQueryPoolCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  create_info.queryCount = pair_cnt * 2;
+  create_info.pipelineStatistics = 0;
+
+  res = vkCreateQueryPool(device, &create_info, app->vk_alloc, &prof->pool);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateQueryPool"); free(prof); return res; }
+
+  app->ld_data[cur_ld].profiler = prof;
+
+  return res;
+}
+
+void dlu_vk_profiler_destroy(vkcomp *app, uint32_t cur_ld) {
+  dlu_vk_profiler *prof = app->ld_data[cur_ld].profiler;
+  if (!prof) return;
+
+  for (uint32_t i = 0; i < prof->scope_cnt; i++)
+    free(prof->scopes[i].name);
+
+  vkDestroyQueryPool(app->ld_data[cur_ld].device, prof->pool, app->vk_alloc);
+  free(prof);
+  app->ld_data[cur_ld].profiler = NULL;
+}
+
+/* Fold a slice's timings into the scopes' windows, without waiting on the GPU */
+static void collect(vkcomp *app, uint32_t cur_ld, dlu_vk_profiler *prof, uint32_t slice) {
+  uint32_t cnt = prof->counts[slice];
+  if (!cnt) return;
+
+  uint32_t first = slice * prof->max_queries * 2;
+
+  /* VK_NOT_READY still writes whatever is available */
+  VkResult res = vkGetQueryPoolResults(app->ld_data[cur_ld].device, prof->pool, first, cnt * 2, cnt * 4 * sizeof(uint64_t),
+                                       prof->results, 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  if (res && res != VK_NOT_READY) { PERR(DLU_VK_FUNC_ERR, res, "vkGetQueryPoolResults"); return; }
+
+  memset(prof->sums, 0, prof->scope_cnt * sizeof(double));
+  memset(prof->seen, 0, prof->scope_cnt * sizeof(bool));
+
+  for (uint32_t i = 0; i < cnt; i++) {
+    uint64_t *pair = &prof->results[i * 4]; /* begin, available, end, available */
+    struct profile_scope *scope = &prof->scopes[prof->owners[(slice * prof->max_queries) + i]];
+    uint32_t id = scope - prof->scopes;
+
+    if (!pair[1] || !pair[3]) { scope->dropped++; continue; }
+
+    /* Masking keeps a counter that wrapped between the two timestamps right */
+    prof->sums[id] += (double) ((pair[2] - pair[0]) & prof->mask) * prof->period / 1000000.0;
+    prof->seen[id] = true;
+  }
+
+  for (uint32_t i = 0; i < prof->scope_cnt; i++) {
+    if (!prof->seen[i]) continue;
+    struct profile_scope *scope = &prof->scopes[i];
+    scope->window[(scope->head + scope->samples) % DLU_VK_PROFILE_WINDOW] = prof->sums[i];
+    if (scope->samples < DLU_VK_PROFILE_WINDOW) scope->samples++;
+    else scope->head = (scope->head + 1) % DLU_VK_PROFILE_WINDOW;
+  }
+}
+
+void dlu_vk_profiler_frame(vkcomp *app, uint32_t cur_ld, VkCommandBuffer cmd_buff) {
+  dlu_vk_profiler *prof = app->ld_data[cur_ld].profiler;
+  if (!prof) { PERR(DLU_VKCOMP_PROFILER, 0, NULL); return; }
+
+  uint32_t slice = prof->frame % prof->frame_lag;
+
+  collect(app, cur_ld, prof, slice);
+
+  /* Queries must be reset before being written again */
+  vkCmdResetQueryPool(cmd_buff, prof->pool, slice * prof->max_queries * 2, prof->max_queries * 2);
+  prof->counts[slice] = 0;
+  prof->frame++;
+}
+
+static struct profile_scope *get_scope(dlu_vk_profiler *prof, const char *name, bool add) {
+  for (uint32_t i = 0; i < prof->scope_cnt; i++)
+    if (!strcmp(prof->scopes[i].name, name)) return &prof->scopes[i];
+
+  if (!add) return NULL;
+  if (prof->scope_cnt == prof->max_scopes) { dlu_log_me(DLU_DANGER, "[x] Profiler is out of scope names, max %u", prof->max_scopes); return NULL; }
+
+  struct profile_scope *scope = &prof->scopes[prof->scope_cnt];
+  scope->name = strdup(name);
+  if (!scope->name) { dlu_log_me(DLU_DANGER, "[x] strdup: %s", strerror(errno)); return NULL; }
+
+  prof->scope_cnt++;
+  return scope;
+}
+
+uint32_t dlu_vk_profiler_begin(vkcomp *app, uint32_t cur_ld, VkCommandBuffer cmd_buff, const char *name) {
+  dlu_vk_profiler *prof = app->ld_data[cur_ld].profiler;
+  if (!prof || !prof->frame) { PERR(DLU_VKCOMP_PROFILER, 0, NULL); return UINT32_MAX; }
+
+  uint32_t slice = (prof->frame - 1) % prof->frame_lag;
+  if (prof->counts[slice] == prof->max_queries) return UINT32_MAX;
+
+  struct profile_scope *scope = get_scope(prof, name, true);
+  if (!scope) return UINT32_MAX;
+
+  uint32_t pair = (slice * prof->max_queries) + prof->counts[slice]++;
+  prof->owners[pair] = scope - prof->scopes;
+
+  /* Written once every prior command started, i.e when the scope's work can begin */
+  vkCmdWriteTimestamp(cmd_buff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, prof->pool, pair * 2);
+
+  return pair;
+}
+
+void dlu_vk_profiler_end(vkcomp *app, uint32_t cur_ld, VkCommandBuffer cmd_buff, uint32_t query) {
+  dlu_vk_profiler *prof = app->ld_data[cur_ld].profiler;
+  if (!prof) { PERR(DLU_VKCOMP_PROFILER, 0, NULL); return; }
+  if (query == UINT32_MAX) return;
+
+  /* Written once every prior command completed */
+  vkCmdWriteTimestamp(cmd_buff, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, prof->pool, (query * 2) + 1);
+}
+
+bool dlu_vk_profiler_get_stats(vkcomp *app, uint32_t cur_ld, const char *name, dlu_vk_profile_stats *stats) {
+  dlu_vk_profiler *prof = app->ld_data[cur_ld].profiler;
+  if (!prof) { PERR(DLU_VKCOMP_PROFILER, 0, NULL); return false; }
+
+  struct profile_scope *scope = get_scope(prof, name, false);
+  if (!scope || !scope->samples) return false;
+
+  stats->last = scope->window[(scope->head + scope->samples - 1) % DLU_VK_PROFILE_WINDOW];
+  stats->min = stats->max = stats->last;
+  stats->avg = 0.0;
+
+  for (uint32_t i = 0; i < scope->samples; i++) {
+    double ms = scope->window[(scope->head + i) % DLU_VK_PROFILE_WINDOW];
+    if (ms < stats->min) stats->min = ms;
+    if (ms > stats->max) stats->max = ms;
+    stats->avg += ms;
+  }
+
+  stats->avg /= scope->samples;
+  stats->samples = scope->samples;
+  stats->dropped = scope->dropped;
+
+  return true;
+}
+
+void dlu_vk_profiler_print_stats(vkcomp *app, uint32_t cur_ld) {
+  dlu_vk_profiler *prof = app->ld_data[cur_ld].profiler;
+  if (!prof) { PERR(DLU_VKCOMP_PROFILER, 0, NULL); return; }
+
+  dlu_vk_profile_stats stats;
+
+  dlu_print_msg(DLU_SUCCESS, "\n  GPU timings over the last %u frames\n", DLU_VK_PROFILE_WINDOW);
+  for (uint32_t i = 0; i < prof->scope_cnt; i++) {
+    if (!dlu_vk_profiler_get_stats(app, cur_ld, prof->scopes[i].name, &stats)) continue;
+    dlu_print_msg(DLU_INFO, "\t%s: %.3f ms (avg %.3f ms, min %.3f ms, max %.3f ms), %u samples, %lu dropped\n",
+                  prof->scopes[i].name, stats.last, stats.avg, stats.min, stats.max, stats.samples, stats.dropped);
+  }
+}
@@ -0,0 +1,269 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+#include <pthread.h>
+
+/**
+* pools      | pools[frame * thread_cnt + thread], each with one secondary in secs at the same index
+* gen        | Bumped for every dlu_vk_record_parallel(3), workers record when it changes
+* pending    | Workers yet to finish the current generation
+* per        | Draws per partition, partition t covers [t * per, min((t + 1) * per, draw_cnt))
+* res        | Result of each thread's partition
+*/
+struct _dlu_vk_recorder {
+  vkcomp *app;
+  VkDevice device;
+  uint32_t thread_cnt;
+  uint32_t frame_cnt;
+  VkCommandPool *pools;
+  VkCommandBuffer *secs;
+
+  pthread_t *threads;
+  uint32_t started;
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t done;
+  uint64_t gen;
+  uint32_t pending;
+  bool quit;
+
+  /* Current job */
+  uint32_t frame;
+  uint32_t per;
+  uint32_t draw_cnt;
+  const VkCommandBufferInheritanceInfo *inherit;
+  dlu_vk_record_fn record;
+  void *data;
+  VkResult *res;
+};
+
+/* Arguments handed to each worker, laid out after the recorder */
+struct worker_arg {
+  dlu_vk_recorder *rec;
+  uint32_t thread;
+};
+
+static VkResult record_partition(dlu_vk_recorder *rec, uint32_t thread) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint32_t first = thread * rec->per;
+  if (first >= rec->draw_cnt) return VK_SUCCESS;
+
+  uint32_t count = rec->draw_cnt - first;
+  if (count > rec->per) count = rec->per;
+
+  uint32_t idx = rec->frame * rec->thread_cnt + thread;
+
+  /* Frees what the frame recorded last time around in one go, cheaper than resetting buffers */
+  res = vkResetCommandPool(rec->device, rec->pools[idx], 0);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkResetCommandPool"); return res; }
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.pNext = NULL;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  begin_info.pInheritanceInfo = rec->inherit;
+
+  res = vkBeginCommandBuffer(rec->secs[idx], &begin_info);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); return res; }
+
+  rec->record(rec->app, rec->secs[idx], thread, first, count, rec->data);
+
+  res = vkEndCommandBuffer(rec->secs[idx]);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkEndCommandBuffer");
+
+  return res;
+}
+
+static void *worker(void *arg) {
+  dlu_vk_recorder *rec = ((struct worker_arg *) arg)->rec;
+  uint32_t thread = ((struct worker_arg *) arg)->thread;
+  uint64_t seen = 0;
+
+  pthread_mutex_lock(&rec->lock);
+  for (;;) {
+    while (!rec->quit && rec->gen == seen)
+      pthread_cond_wait(&rec->work, &rec->lock);
+    if (rec->quit) break;
+    seen = rec->gen;
+    pthread_mutex_unlock(&rec->lock);
+
+    VkResult res = record_partition(rec, thread);
+
+    pthread_mutex_lock(&rec->lock);
+    rec->res[thread] = res;
+    if (--rec->pending == 0) pthread_cond_signal(&rec->done);
+  }
+  pthread_mutex_unlock(&rec->lock);
+
+  return NULL;
+}
+
+static void free_recorder(dlu_vk_recorder *rec) {
+  pthread_mutex_lock(&rec->lock);
+  rec->quit = true;
+  pthread_cond_broadcast(&rec->work);
+  pthread_mutex_unlock(&rec->lock);
+
+  for (uint32_t i = 0; i < rec->started; i++)
+    pthread_join(rec->threads[i], NULL);
+
+  /* Destroying a pool frees its command buffers */
+  for (uint32_t i = 0; i < rec->thread_cnt * rec->frame_cnt; i++)
+    if (rec->pools[i]) vkDestroyCommandPool(rec->device, rec->pools[i], rec->app->vk_alloc);
+
+  pthread_cond_destroy(&rec->done);
+  pthread_cond_destroy(&rec->work);
+  pthread_mutex_destroy(&rec->lock);
+  free(rec);
+}
+
+VkResult dlu_vk_recorder_create(vkcomp *app, uint32_t cur_pool, uint32_t queueFamilyIndex, uint32_t thread_cnt, uint32_t frame_cnt) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!app->cmd_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_CMD_DATA"); return res; }
+  if (!app->cmd_data[cur_pool].cmd_pool) { PERR(DLU_VKCOMP_CMD_POOL, 0, NULL); return res; }
+  if (app->cmd_data[cur_pool].recorder) { dlu_log_me(DLU_DANGER, "[x] Command pool %u already has a recorder", cur_pool); return res; }
+  if (!thread_cnt || !frame_cnt) { dlu_log_me(DLU_DANGER, "[x] A recorder needs at least one thread and one frame"); return res; }
+
+  uint32_t pool_cnt = thread_cnt * frame_cnt;
+  size_t size = sizeof(dlu_vk_recorder) + (pool_cnt * (sizeof(VkCommandPool) + sizeof(VkCommandBuffer)))
+              + (thread_cnt * (sizeof(pthread_t) + sizeof(VkResult) + sizeof(struct worker_arg)));
+
+  dlu_vk_recorder *rec = calloc(1, size);
+  if (!rec) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+
+  /* Largest alignment first, handles are 8 bytes */
+  rec->pools = (VkCommandPool *) (rec + 1);
+  rec->secs = (VkCommandBuffer *) (rec->pools + pool_cnt);
+  struct worker_arg *args = (struct worker_arg *) (rec->secs + pool_cnt);
+  rec->threads = (pthread_t *) (args + thread_cnt);
+  rec->res = (VkResult *) (rec->threads + thread_cnt);
+
+  rec->app = app;
+  rec->device = app->ld_data[app->cmd_data[cur_pool].ldi].device;
+  rec->thread_cnt = thread_cnt;
+  rec->frame_cnt = frame_cnt;
+  pthread_mutex_init(&rec->lock, NULL);
+  pthread_cond_init(&rec->work, NULL);
+  pthread_cond_init(&rec->done, NULL);
+
+  VkCommandPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  pool_info.pNext = NULL;
+  pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  pool_info.queueFamilyIndex = queueFamilyIndex;
+
+  VkCommandBufferAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  alloc_info.pNext = NULL;
+  alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+  alloc_info.commandBufferCount = 1;
+
+  for (uint32_t i = 0; i < pool_cnt; i++) {
+    res = vkCreateCommandPool(rec->device, &pool_info, app->vk_alloc, &rec->pools[i]);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateCommandPool"); goto err_free; }
+
+    alloc_info.commandPool = rec->pools[i];
+    res = vkAllocateCommandBuffers(rec->device, &alloc_info, &rec->secs[i]);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateCommandBuffers"); goto err_free; }
+  }
+
+  /* Thread 0 is the caller of dlu_vk_record_parallel() */
+  for (uint32_t i = 1; i < thread_cnt; i++) {
+    args[i].rec = rec;
+    args[i].thread = i;
+    int err = pthread_create(&rec->threads[rec->started], NULL, worker, &args[i]);
+    if (err) { dlu_log_me(DLU_DANGER, "[x] pthread_create: %s", strerror(err)); res = VK_ERROR_INITIALIZATION_FAILED; goto err_free; }
+    rec->started++;
+  }
+
+  app->cmd_data[cur_pool].recorder = rec;
+
+  return VK_SUCCESS;
+
+err_free:
+  free_recorder(rec);
+  return res;
+}
+
+void dlu_vk_recorder_destroy(vkcomp *app, uint32_t cur_pool) {
+  dlu_vk_recorder *rec = app->cmd_data[cur_pool].recorder;
+  if (!rec) return;
+
+  free_recorder(rec);
+  app->cmd_data[cur_pool].recorder = NULL;
+}
+
+VkResult dlu_vk_record_parallel(
+  vkcomp *app,
+  uint32_t cur_pool,
+  uint32_t cur_buff,
+  uint32_t frame,
+  const VkCommandBufferInheritanceInfo *inherit,
+  uint32_t draw_cnt,
+  dlu_vk_record_fn record,
+  void *data
+) {
+
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_recorder *rec = app->cmd_data[cur_pool].recorder;
+
+  if (!rec) { PERR(DLU_VKCOMP_RECORDER, 0, NULL); return res; }
+  if (frame >= rec->frame_cnt) { dlu_log_me(DLU_DANGER, "[x] Frame %u is out of the recorder's %u frames", frame, rec->frame_cnt); return res; }
+  if (!draw_cnt) return VK_SUCCESS;
+
+  rec->frame = frame;
+  rec->draw_cnt = draw_cnt;
+  rec->per = (draw_cnt + rec->thread_cnt - 1) / rec->thread_cnt;
+  rec->inherit = inherit;
+  rec->record = record;
+  rec->data = data;
+
+  /* Small draw lists have fewer partitions than threads, workers past the last one return right away */
+  uint32_t parts = (draw_cnt + rec->per - 1) / rec->per;
+
+  pthread_mutex_lock(&rec->lock);
+  rec->pending = rec->thread_cnt - 1;
+  rec->gen++;
+  pthread_cond_broadcast(&rec->work);
+  pthread_mutex_unlock(&rec->lock);
+
+  rec->res[0] = record_partition(rec, 0);
+
+  pthread_mutex_lock(&rec->lock);
+  while (rec->pending)
+    pthread_cond_wait(&rec->done, &rec->lock);
+  pthread_mutex_unlock(&rec->lock);
+
+  for (uint32_t i = 0; i < parts; i++)
+    if (rec->res[i]) return rec->res[i];
+
+  /* Secondaries execute in partition order, so draw order is kept */
+  vkCmdExecuteCommands(app->cmd_data[cur_pool].cmd_buffs[cur_buff], parts, &rec->secs[frame * rec->thread_cnt]);
+
+  return VK_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+static VkDeviceSize align_up(VkDeviceSize size, VkDeviceSize align) {
+  return (size + align - 1) & ~(align - 1);
+}
+
+VkResult dlu_create_uniform_ring(vkcomp *app, uint32_t cur_ld, uint32_t cur_bd, uint32_t frame_cnt, VkDeviceSize frame_size) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkPhysicalDeviceProperties device_props;
+
+  if (!app->buff_data) { PERR(DLU_BUFF_NOT_ALLOC, 0, "DLU_BUFF_DATA"); return res; }
+
+  vkGetPhysicalDeviceProperties(app->pd_data[app->ld_data[cur_ld].pdi].phys_dev, &device_props);
+
+  /* minUniformBufferOffsetAlignment is always a power of two */
+  struct _uniform_ring *ring = &app->buff_data[cur_bd].ring;
+  ring->align = device_props.limits.minUniformBufferOffsetAlignment;
+  if (!ring->align) ring->align = 1;
+  ring->frame_size = align_up(frame_size, ring->align);
+  ring->frame = ring->head = ring->frame_cnt = 0;
+
+  if ((ring->frame_size * frame_cnt) > UINT32_MAX) {
+    dlu_log_me(DLU_DANGER, "[x] dlu_create_uniform_ring: dynamic offsets are 32 bits, %u slices of %lu bytes don't fit", frame_cnt, ring->frame_size);
+    ring->frame_size = 0;
+    return res;
+  }
+
+  res = dlu_create_vk_buffer(app, cur_ld, cur_bd, ring->frame_size * frame_cnt, 0, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                             VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+  if (res) { ring->frame_size = 0; return res; }
+
+  /* Writes go straight into the persistent mapping */
+  if (!app->buff_data[cur_bd].sub.map) {
+    PERR(DLU_VKCOMP_MEM_NOT_MAPPED, 0, NULL);
+    ring->frame_size = 0;
+    return VK_RESULT_MAX_ENUM;
+  }
+
+  ring->frame_cnt = frame_cnt;
+
+  return res;
+}
+
+VkResult dlu_uniform_ring_begin(vkcomp *app, uint32_t cur_bd, uint32_t frame) {
+  struct _uniform_ring *ring = &app->buff_data[cur_bd].ring;
+
+  /* A slice passed the end would hand out offsets outside of the buffer */
+  if (frame >= ring->frame_cnt) {
+    dlu_log_me(DLU_DANGER, "[x] Uniform ring %u has %u slices, can't begin frame %u", cur_bd, ring->frame_cnt, frame);
+    return VK_RESULT_MAX_ENUM;
+  }
+
+  ring->frame = frame;
+  ring->head = 0;
+
+  return VK_SUCCESS;
+}
+
+void *dlu_uniform_ring_alloc(vkcomp *app, uint32_t cur_bd, VkDeviceSize size, uint32_t *dyn_offset) {
+  struct _uniform_ring *ring = &app->buff_data[cur_bd].ring;
+  VkDeviceSize offset = 0;
+
+  if (!ring->frame_size) {
+    dlu_log_me(DLU_DANGER, "[x] Buffer %u isn't a uniform ring, must make a call to dlu_create_uniform_ring()", cur_bd);
+    return NULL;
+  }
+
+  if ((ring->head + size) > ring->frame_size) {
+    dlu_log_me(DLU_DANGER, "[x] Uniform ring slice of frame %u is full, %lu of %lu bytes used", ring->frame, ring->head, ring->frame_size);
+    return NULL;
+  }
+
+  offset = (ring->frame * ring->frame_size) + ring->head;
+  ring->head = align_up(ring->head + size, ring->align);
+
+  *dyn_offset = (uint32_t) offset;
+  return (char *) app->buff_data[cur_bd].sub.map + offset;
+}
+
+VkResult dlu_uniform_ring_push(vkcomp *app, uint32_t cur_bd, VkDeviceSize size, const void *data, uint32_t *dyn_offset) {
+  void *p_data = dlu_uniform_ring_alloc(app, cur_bd, size, dyn_offset);
+  if (!p_data) return VK_RESULT_MAX_ENUM;
+
+  memcpy(p_data, data, size);
+
+  return VK_SUCCESS;
+}
+
+VkResult dlu_uniform_ring_end(vkcomp *app, uint32_t cur_bd) {
+  struct _uniform_ring *ring = &app->buff_data[cur_bd].ring;
+  if (!ring->head) return VK_SUCCESS;
+
+  return dlu_vk_flush_mem(DLU_VK_BUFFER, app, cur_bd, ring->frame * ring->frame_size, ring->head);
+}
@@ -31,17 +31,33 @@ vkcomp *dlu_init_vk() {
   return app;
 }
 
+/* Depth and multisampled color targets are sized to the swap chain, they go with it */
+static void free_sc_attachment(vkcomp *app, uint32_t cur_scd, struct _sc_attachment *att) {
+  if (att->view) {
+    vkDestroyImageView(app->ld_data[app->sc_data[cur_scd].ldi].device, att->view, app->vk_alloc);
+    att->view = VK_NULL_HANDLE;
+  }
+  if (att->image) {
+    vkDestroyImage(app->ld_data[app->sc_data[cur_scd].ldi].device, att->image, app->vk_alloc);
+    att->image = VK_NULL_HANDLE;
+  }
+  if (att->mem) {
+    dlu_vk_mem_free(app, app->sc_data[cur_scd].ldi, att->mem, &att->sub);
+    att->mem = VK_NULL_HANDLE;
+  }
+}
+
 void dlu_freeup_sc(vkcomp *app) {
 
   /* destory all uniform buffers */
   if (app->buff_data) {
     for (uint32_t i = 0; i < app->bdc; i++) {
       if (app->buff_data[i].buff) {
-        vkDestroyBuffer(app->ld_data[app->buff_data[i].ldi].device, app->buff_data[i].buff, NULL);
+        vkDestroyBuffer(app->ld_data[app->buff_data[i].ldi].device, app->buff_data[i].buff, app->vk_alloc);
         app->buff_data[i].buff = VK_NULL_HANDLE;
       }
       if (app->buff_data[i].mem) {
-        vkFreeMemory(app->ld_data[app->buff_data[i].ldi].device, app->buff_data[i].mem, NULL);
+        dlu_vk_mem_free(app, app->buff_data[i].ldi, app->buff_data[i].mem, &app->buff_data[i].sub);
         app->buff_data[i].mem = VK_NULL_HANDLE;
       }
     }
@@ -50,7 +66,7 @@ void dlu_freeup_sc(vkcomp *app) {
   if (app->desc_data) {
     for (uint32_t i = 0; i < app->ddc; i++) {
       if (app->desc_data[i].desc_pool) {
-        vkDestroyDescriptorPool(app->ld_data[app->desc_data[i].ldi].device, app->desc_data[i].desc_pool, NULL);
+        vkDestroyDescriptorPool(app->ld_data[app->desc_data[i].ldi].device, app->desc_data[i].desc_pool, app->vk_alloc);
         app->desc_data[i].desc_pool = VK_NULL_HANDLE;
       }
     }
@@ -64,23 +80,23 @@ void dlu_freeup_sc(vkcomp *app) {
   }
 
   if (app->gp_cache.pipe_cache) {
-    vkDestroyPipelineCache(app->ld_data[app->gp_cache.ldi].device, app->gp_cache.pipe_cache, NULL);
+    vkDestroyPipelineCache(app->ld_data[app->gp_cache.ldi].device, app->gp_cache.pipe_cache, app->vk_alloc);
     app->gp_cache.pipe_cache = VK_NULL_HANDLE;
   }
 
   if (app->gp_data) {
     for (uint32_t i = 0; i < app->gdc; i++) {
       if (app->gp_data[i].pipeline_layout) {
-        vkDestroyPipelineLayout(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].pipeline_layout, NULL);
+        vkDestroyPipelineLayout(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].pipeline_layout, app->vk_alloc);
         app->gp_data[i].pipeline_layout = VK_NULL_HANDLE;
       }
       if (app->gp_data[i].render_pass) {
-        vkDestroyRenderPass(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].render_pass, NULL);
+        vkDestroyRenderPass(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].render_pass, app->vk_alloc);
         app->gp_data[i].render_pass = VK_NULL_HANDLE;
       }
       for (uint32_t j = 0; j < app->gp_data[i].gpc; j++) {
         if (app->gp_data[i].graphics_pipelines[j]) {
-          vkDestroyPipeline(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].graphics_pipelines[j], NULL);
+          vkDestroyPipeline(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].graphics_pipelines[j], app->vk_alloc);
           app->gp_data[i].graphics_pipelines[j] = VK_NULL_HANDLE;
         }
       }
@@ -89,25 +105,28 @@ void dlu_freeup_sc(vkcomp *app) {
 
   if (app->sc_data) {
     for (uint32_t i = 0; i < app->sdc; i++) {
+      free_sc_attachment(app, i, &app->sc_data[i].depth);
+      free_sc_attachment(app, i, &app->sc_data[i].msaa);
+
       if (app->sc_data[i].sc_buffs) {
         for (uint32_t j = 0; j < app->sc_data[i].sic; j++) {
           if (app->sc_data[i].sc_buffs[j].fb) {
-            vkDestroyFramebuffer(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].fb, NULL);
+            vkDestroyFramebuffer(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].fb, app->vk_alloc);
             app->sc_data[i].sc_buffs[j].fb = VK_NULL_HANDLE;
           }
           if (app->sc_data[i].sc_buffs[j].view) {
-            vkDestroyImageView(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].view, NULL);
+            vkDestroyImageView(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].view, app->vk_alloc);
             app->sc_data[i].sc_buffs[j].view = VK_NULL_HANDLE;
           }
           if (app->sc_data[i].sc_buffs[j].image) {
-            vkDestroyImage(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].image, NULL);
+            vkDestroyImage(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].image, app->vk_alloc);
             app->sc_data[i].sc_buffs[j].image = VK_NULL_HANDLE;
           }
         }
       }
 
       if (app->sc_data[i].swap_chain) {
-        vkDestroySwapchainKHR(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].swap_chain, NULL);
+        vkDestroySwapchainKHR(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].swap_chain, app->vk_alloc);
         app->sc_data[i].swap_chain = VK_NULL_HANDLE;
       }
     }
@@ -122,39 +141,48 @@ void dlu_freeup_vk(vkcomp *app) {
       vkQueueWaitIdle(app->ld_data[i].graphics);
 
   if (app->debug_utils_msg)
-    app->dbg_destroy_utils_msg(app->instance, app->debug_utils_msg, NULL);
+    app->dbg_destroy_utils_msg(app->instance, app->debug_utils_msg, app->vk_alloc);
 
   if (app->cmd_data) {
     for (uint32_t i = 0; i < app->cdc; i++) {
+      for (uint32_t j = 0; j < DLU_EXEC_BATCH_CNT; j++) {
+        struct _cmd_batch *batch = &app->cmd_data[i].batches[j];
+        if (!batch->fence) continue;
+        /* Batches still recording were never submitted, their fences never signal */
+        if (batch->ticket && !batch->recording)
+          vkWaitForFences(app->ld_data[app->cmd_data[i].ldi].device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(app->ld_data[app->cmd_data[i].ldi].device, batch->fence, app->vk_alloc);
+      }
+      dlu_vk_recorder_destroy(app, i);
       if (app->cmd_data[i].cmd_pool)
-        vkDestroyCommandPool(app->ld_data[app->cmd_data[i].ldi].device, app->cmd_data[i].cmd_pool, NULL);
+        vkDestroyCommandPool(app->ld_data[app->cmd_data[i].ldi].device, app->cmd_data[i].cmd_pool, app->vk_alloc);
     }
   }
 
   if (app->gp_cache.pipe_cache)
-    vkDestroyPipelineCache(app->ld_data[app->gp_cache.ldi].device, app->gp_cache.pipe_cache, NULL);
+    vkDestroyPipelineCache(app->ld_data[app->gp_cache.ldi].device, app->gp_cache.pipe_cache, app->vk_alloc);
  
   if (app->text_data) {
     for (uint32_t i = 0; i < app->tdc; i++) {
       if (app->text_data[i].sampler)
-        vkDestroySampler(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].sampler, NULL);
+        vkDestroySampler(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].sampler, app->vk_alloc);
       if (app->text_data[i].view)
-        vkDestroyImageView(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].view, NULL);
+        vkDestroyImageView(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].view, app->vk_alloc);
       if (app->text_data[i].image)
-        vkDestroyImage(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].image, NULL);
+        vkDestroyImage(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].image, app->vk_alloc);
       if (app->text_data[i].mem)
-        vkFreeMemory(app->ld_data[app->text_data[i].ldi].device, app->text_data[i].mem, NULL);
+        dlu_vk_mem_free(app, app->text_data[i].ldi, app->text_data[i].mem, &app->text_data[i].sub);
     }
   }
 
   if (app->gp_data) {
     for (uint32_t i = 0; i < app->gdc; i++) {
       if (app->gp_data[i].pipeline_layout)
-        vkDestroyPipelineLayout(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].pipeline_layout, NULL);
+        vkDestroyPipelineLayout(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].pipeline_layout, app->vk_alloc);
       if (app->gp_data[i].render_pass)
-        vkDestroyRenderPass(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].render_pass, NULL);
+        vkDestroyRenderPass(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].render_pass, app->vk_alloc);
       for (uint32_t j = 0; j < app->gp_data[i].gpc; j++)
-        vkDestroyPipeline(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].graphics_pipelines[j], NULL);
+        vkDestroyPipeline(app->ld_data[app->gp_data[i].ldi].device, app->gp_data[i].graphics_pipelines[j], app->vk_alloc);
     }
   }
 
@@ -163,59 +191,65 @@ void dlu_freeup_vk(vkcomp *app) {
       if (app->desc_data[i].layouts) {
         for (uint32_t j = 0; j < app->desc_data[i].dlsc; j++) {
           if (app->desc_data[i].layouts[j])
-            vkDestroyDescriptorSetLayout(app->ld_data[app->desc_data[i].ldi].device, app->desc_data[i].layouts[j], NULL);
+            vkDestroyDescriptorSetLayout(app->ld_data[app->desc_data[i].ldi].device, app->desc_data[i].layouts[j], app->vk_alloc);
         }
       }
       if (app->desc_data[i].desc_pool)
-        vkDestroyDescriptorPool(app->ld_data[app->desc_data[i].ldi].device, app->desc_data[i].desc_pool, NULL);
+        vkDestroyDescriptorPool(app->ld_data[app->desc_data[i].ldi].device, app->desc_data[i].desc_pool, app->vk_alloc);
     }
   }
 
   if (app->buff_data) {
     for (uint32_t i = 0; i < app->bdc; i++) {
       if (app->buff_data[i].buff)
-        vkDestroyBuffer(app->ld_data[app->buff_data[i].ldi].device, app->buff_data[i].buff, NULL);
+        vkDestroyBuffer(app->ld_data[app->buff_data[i].ldi].device, app->buff_data[i].buff, app->vk_alloc);
       if (app->buff_data[i].mem)
-        vkFreeMemory(app->ld_data[app->buff_data[i].ldi].device, app->buff_data[i].mem, NULL);
+        dlu_vk_mem_free(app, app->buff_data[i].ldi, app->buff_data[i].mem, &app->buff_data[i].sub);
     }
   }
 
   if (app->sc_data) { /* Annihilate All Swap Chain Objects */
     for (uint32_t i = 0; i < app->sdc; i++) {
-      if (app->sc_data[i].depth.view)
-        vkDestroyImageView(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].depth.view, NULL);
-      if (app->sc_data[i].depth.image)
-        vkDestroyImage(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].depth.image, NULL);
-      if (app->sc_data[i].depth.mem)
-        vkFreeMemory(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].depth.mem, NULL);
+      dlu_vk_frame_destroy(app, i);
+      free_sc_attachment(app, i, &app->sc_data[i].depth);
+      free_sc_attachment(app, i, &app->sc_data[i].msaa);
       if (app->sc_data[i].sc_buffs && app->sc_data[i].syncs) {
         for (uint32_t j = 0; j < app->sc_data[i].sic; j++) {
           if (app->sc_data[i].syncs[j].sem.image)
-            vkDestroySemaphore(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].syncs[j].sem.image, NULL);
+            vkDestroySemaphore(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].syncs[j].sem.image, app->vk_alloc);
           if (app->sc_data[i].syncs[j].sem.render)
-            vkDestroySemaphore(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].syncs[j].sem.render, NULL);
+            vkDestroySemaphore(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].syncs[j].sem.render, app->vk_alloc);
           if (app->sc_data[i].syncs[j].fence.render)
-            vkDestroyFence(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].syncs[j].fence.render, NULL);
+            vkDestroyFence(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].syncs[j].fence.render, app->vk_alloc);
           if (app->sc_data[i].sc_buffs[j].fb)
-            vkDestroyFramebuffer(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].fb, NULL);
+            vkDestroyFramebuffer(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].fb, app->vk_alloc);
           if (app->sc_data[i].sc_buffs[j].view)
-            vkDestroyImageView(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].view, NULL);
+            vkDestroyImageView(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].sc_buffs[j].view, app->vk_alloc);
         }
       }
       if (app->sc_data[i].swap_chain)
-        vkDestroySwapchainKHR(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].swap_chain, NULL);
+        vkDestroySwapchainKHR(app->ld_data[app->sc_data[i].ldi].device, app->sc_data[i].swap_chain, app->vk_alloc);
     }
   }
 
   if (app->ld_data) {
-    for (uint32_t i = 0; i < app->ldc; i++)
-      if (app->ld_data[i].device)
-        vkDestroyDevice(app->ld_data[i].device, NULL);
+    for (uint32_t i = 0; i < app->ldc; i++) {
+      if (app->ld_data[i].device) {
+        dlu_vk_upload_destroy(app, i);
+        dlu_vk_bindless_destroy(app, i);
+        dlu_vk_timeline_destroy(app, i);
+        dlu_vk_profiler_destroy(app, i);
+        dlu_vk_mem_pool_destroy(app, i);
+        vkDestroyDevice(app->ld_data[i].device, app->vk_alloc);
+      }
+    }
   }
 
   if (app->surface)
-    vkDestroySurfaceKHR(app->instance, app->surface, NULL);
+    vkDestroySurfaceKHR(app->instance, app->surface, app->vk_alloc);
 
   if (app->instance)
-    vkDestroyInstance(app->instance, NULL);
+    vkDestroyInstance(app->instance, app->vk_alloc);
+
+  dlu_vk_host_alloc_destroy(app);
 }
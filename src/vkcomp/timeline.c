@@ -0,0 +1,223 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+/**
+* sems | Timeline semaphore of each queue, VK_NULL_HANDLE if the device lacks the queue
+* last | Latest point handed out for each queue, the semaphore's value once it's idle
+*/
+struct _dlu_vk_timelines {
+  VkSemaphore sems[DLU_VK_QUEUE_CNT];
+  uint64_t last[DLU_VK_QUEUE_CNT];
+};
+
+static VkQueue get_queue(vkcomp *app, uint32_t cur_ld, dlu_queue_type queue) {
+  switch (queue) {
+    case DLU_VK_GRAPHICS_QUEUE: return app->ld_data[cur_ld].graphics;
+    case DLU_VK_TRANSFER_QUEUE: return app->ld_data[cur_ld].transfer;
+    case DLU_VK_COMPUTE_QUEUE: return app->ld_data[cur_ld].compute;
+    default: return VK_NULL_HANDLE;
+  }
+}
+
+static bool has_timeline(vkcomp *app, uint32_t cur_ld, dlu_queue_type queue) {
+  dlu_vk_timelines *tl = app->ld_data[cur_ld].timelines;
+  if (!tl) { PERR(DLU_VKCOMP_TIMELINE, 0, NULL); return false; }
+  if (queue >= DLU_VK_QUEUE_CNT || !tl->sems[queue]) {
+    dlu_log_me(DLU_DANGER, "[x] Logical device %u has no timeline for queue %u, was it retrieved with dlu_create_device_queue()?", cur_ld, queue);
+    return false;
+  }
+  return true;
+}
+
+VkResult dlu_vk_timeline_create(vkcomp *app, uint32_t cur_ld) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!app->ld_data[cur_ld].device) { PERR(DLU_VKCOMP_DEVICE, 0, NULL); return res; }
+  if (app->ld_data[cur_ld].timelines) return VK_SUCCESS;
+  if (!app->ld_data[cur_ld].timeline) {
+    dlu_log_me(DLU_DANGER, "[x] %s must be enabled with dlu_create_logical_device()", VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    return res;
+  }
+
+  dlu_vk_timelines *tl = calloc(1, sizeof(dlu_vk_timelines));
+  if (!tl) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+  app->ld_data[cur_ld].timelines = tl;
+
+  VkSemaphoreTypeCreateInfo type_info = {};
+  type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  type_info.pNext = NULL;
+  type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  type_info.initialValue = 0;
+
+  VkSemaphoreCreateInfo sem_info = {};
+  sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  sem_info.pNext = &type_info;
+  sem_info.flags = 0;
+
+  for (uint32_t i = 0; i < DLU_VK_QUEUE_CNT; i++) {
+    if (!get_queue(app, cur_ld, i)) continue;
+    res = vkCreateSemaphore(app->ld_data[cur_ld].device, &sem_info, app->vk_alloc, &tl->sems[i]);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateSemaphore"); dlu_vk_timeline_destroy(app, cur_ld); return res; }
+  }
+
+  return VK_SUCCESS;
+}
+
+void dlu_vk_timeline_destroy(vkcomp *app, uint32_t cur_ld) {
+  dlu_vk_timelines *tl = app->ld_data[cur_ld].timelines;
+  if (!tl) return;
+
+  VkSemaphore sems[DLU_VK_QUEUE_CNT];
+  uint64_t values[DLU_VK_QUEUE_CNT];
+  uint32_t cnt = 0;
+
+  for (uint32_t i = 0; i < DLU_VK_QUEUE_CNT; i++) {
+    if (!tl->sems[i] || !tl->last[i]) continue;
+    sems[cnt] = tl->sems[i]; values[cnt++] = tl->last[i];
+  }
+
+  if (cnt) {
+    VkSemaphoreWaitInfo wait_info = {};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.pNext = NULL;
+    wait_info.flags = 0;
+    wait_info.semaphoreCount = cnt;
+    wait_info.pSemaphores = sems;
+    wait_info.pValues = values;
+
+    VkResult res = app->ld_data[cur_ld].wait_sems(app->ld_data[cur_ld].device, &wait_info, UINT64_MAX);
+    if (res) PERR(DLU_VK_FUNC_ERR, res, "vkWaitSemaphoresKHR");
+  }
+
+  for (uint32_t i = 0; i < DLU_VK_QUEUE_CNT; i++)
+    if (tl->sems[i]) vkDestroySemaphore(app->ld_data[cur_ld].device, tl->sems[i], app->vk_alloc);
+
+  free(tl);
+  app->ld_data[cur_ld].timelines = NULL;
+}
+
+VkResult dlu_vk_timeline_submit(
+  vkcomp *app,
+  uint32_t cur_ld,
+  dlu_queue_type queue,
+  uint32_t commandBufferCount,
+  const VkCommandBuffer *pCommandBuffers,
+  uint32_t waitCount,
+  const dlu_vk_timeline_point *pWaits,
+  const VkPipelineStageFlags *pWaitStages,
+  uint64_t *point
+) {
+
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  if (!has_timeline(app, cur_ld, queue)) return res;
+  for (uint32_t i = 0; i < waitCount; i++)
+    if (!has_timeline(app, cur_ld, pWaits[i].queue)) return res;
+
+  dlu_vk_timelines *tl = app->ld_data[cur_ld].timelines;
+  VkSemaphore *wait_sems = alloca(waitCount * sizeof(VkSemaphore));
+  uint64_t *wait_values = alloca(waitCount * sizeof(uint64_t));
+  for (uint32_t i = 0; i < waitCount; i++) {
+    wait_sems[i] = tl->sems[pWaits[i].queue];
+    wait_values[i] = pWaits[i].value;
+  }
+
+  uint64_t signal_value = tl->last[queue] + 1;
+
+  VkTimelineSemaphoreSubmitInfo timeline_info = {};
+  timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timeline_info.pNext = NULL;
+  timeline_info.waitSemaphoreValueCount = waitCount;
+  timeline_info.pWaitSemaphoreValues = wait_values;
+  timeline_info.signalSemaphoreValueCount = 1;
+  timeline_info.pSignalSemaphoreValues = &signal_value;
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = &timeline_info;
+  submit_info.waitSemaphoreCount = waitCount;
+  submit_info.pWaitSemaphores = wait_sems;
+  submit_info.pWaitDstStageMask = pWaitStages;
+  submit_info.commandBufferCount = commandBufferCount;
+  submit_info.pCommandBuffers = pCommandBuffers;
+  submit_info.signalSemaphoreCount = 1;
+  submit_info.pSignalSemaphores = &tl->sems[queue];
+
+  /* No fence, the host waits on the point instead */
+  res = vkQueueSubmit(get_queue(app, cur_ld, queue), 1, &submit_info, VK_NULL_HANDLE);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkQueueSubmit"); return res; }
+
+  tl->last[queue] = signal_value;
+  if (point) *point = signal_value;
+
+  return res;
+}
+
+uint64_t dlu_vk_timeline_completed(vkcomp *app, uint32_t cur_ld, dlu_queue_type queue) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  uint64_t value = 0;
+
+  if (!has_timeline(app, cur_ld, queue)) return value;
+
+  res = app->ld_data[cur_ld].get_sem_value(app->ld_data[cur_ld].device, app->ld_data[cur_ld].timelines->sems[queue], &value);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkGetSemaphoreCounterValueKHR"); return 0; }
+
+  return value;
+}
+
+uint64_t dlu_vk_timeline_last(vkcomp *app, uint32_t cur_ld, dlu_queue_type queue) {
+  if (!has_timeline(app, cur_ld, queue)) return 0;
+  return app->ld_data[cur_ld].timelines->last[queue];
+}
+
+VkResult dlu_vk_timeline_wait(vkcomp *app, uint32_t cur_ld, uint32_t pointCount, const dlu_vk_timeline_point *pPoints, uint64_t timeout) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  for (uint32_t i = 0; i < pointCount; i++)
+    if (!has_timeline(app, cur_ld, pPoints[i].queue)) return res;
+  if (!pointCount) return VK_SUCCESS;
+
+  VkSemaphore *sems = alloca(pointCount * sizeof(VkSemaphore));
+  uint64_t *values = alloca(pointCount * sizeof(uint64_t));
+  for (uint32_t i = 0; i < pointCount; i++) {
+    sems[i] = app->ld_data[cur_ld].timelines->sems[pPoints[i].queue];
+    values[i] = pPoints[i].value;
+  }
+
+  VkSemaphoreWaitInfo wait_info = {};
+  wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  wait_info.pNext = NULL;
+  wait_info.flags = 0; /* Wait on all points, not any */
+  wait_info.semaphoreCount = pointCount;
+  wait_info.pSemaphores = sems;
+  wait_info.pValues = values;
+
+  res = app->ld_data[cur_ld].wait_sems(app->ld_data[cur_ld].device, &wait_info, timeout);
+  if (res && res != VK_TIMEOUT) PERR(DLU_VK_FUNC_ERR, res, "vkWaitSemaphoresKHR");
+
+  return res;
+}
@@ -0,0 +1,577 @@
+/**
+* The MIT License (MIT)
+*
+* Copyright (c) 2019-2020 Vincent Davis Jr.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*/
+
+#define LUCUR_VKCOMP_API
+#include <lucom.h>
+
+/* bufferOffset of a buffer to image copy must be a multiple of the texel size */
+#define STAGING_ALIGN 16
+
+/**
+* A batch of uploads
+* xfer      | Copies and release barriers, submitted on the transfer queue
+* acquire   | Acquire barriers, submitted on the graphics queue (only with an ownership transfer)
+* sem       | Signaled by the transfer submission, waited on by the acquire submission
+* fence     | Signaled once every upload of the batch is usable by the graphics queue
+* staging   | Persistently mapped staging buffer the batch's data is copied from
+* size      | Size of the staging buffer
+* head      | Bytes of the staging buffer used
+* ticket    | Ticket of the batch, 0 if the slot was never used
+* recording | Commands are being recorded, the batch isn't submitted yet
+*/
+struct upload_batch {
+  VkCommandBuffer xfer;
+  VkCommandBuffer acquire;
+  VkSemaphore sem;
+  VkFence fence;
+  VkBuffer staging;
+  VkDeviceMemory mem;
+  dlu_vk_suballoc sub;
+  VkDeviceSize size;
+  VkDeviceSize head;
+  uint64_t ticket;
+  bool recording;
+};
+
+struct _dlu_vk_uploader {
+  VkCommandPool xfer_pool;
+  VkCommandPool acquire_pool;
+  VkQueue xfer_queue;
+  VkQueue gfx_queue;
+  uint32_t xfam_idx;
+  uint32_t gfam_idx;
+  bool ownership; /* The transfer and graphics families differ, resources change owner */
+  VkDeviceSize staging_size;
+  uint64_t next_ticket; /* Ticket of the batch being recorded, or of the next one to be */
+  struct upload_batch batches[DLU_VK_UPLOAD_BATCH_CNT];
+};
+
+static VkResult create_staging(vkcomp *app, uint32_t cur_ld, struct upload_batch *batch, VkDeviceSize size) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = app->ld_data[cur_ld].device;
+
+  VkBufferCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.size = size;
+  create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  res = vkCreateBuffer(device, &create_info, app->vk_alloc, &batch->staging);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateBuffer"); return res; }
+
+  VkMemoryRequirements mem_reqs;
+  vkGetBufferMemoryRequirements(device, batch->staging, &mem_reqs);
+
+  res = dlu_vk_mem_alloc(app, cur_ld, &mem_reqs, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, true, &batch->mem, &batch->sub);
+  if (res) goto finish_staging;
+
+  res = vkBindBufferMemory(device, batch->staging, batch->mem, batch->sub.offset);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBindBufferMemory"); goto finish_staging; }
+
+  batch->size = size;
+  return res;
+
+finish_staging:
+  vkDestroyBuffer(device, batch->staging, app->vk_alloc); batch->staging = VK_NULL_HANDLE;
+  dlu_vk_mem_free(app, cur_ld, batch->mem, &batch->sub); batch->mem = VK_NULL_HANDLE;
+  return res;
+}
+
+static void destroy_staging(vkcomp *app, uint32_t cur_ld, struct upload_batch *batch) {
+  if (batch->staging) vkDestroyBuffer(app->ld_data[cur_ld].device, batch->staging, app->vk_alloc);
+  dlu_vk_mem_free(app, cur_ld, batch->mem, &batch->sub);
+  batch->staging = VK_NULL_HANDLE; batch->mem = VK_NULL_HANDLE;
+  batch->size = 0;
+}
+
+static struct upload_batch *get_batch(dlu_vk_uploader *up, uint64_t ticket) {
+  return &up->batches[(ticket - 1) % DLU_VK_UPLOAD_BATCH_CNT];
+}
+
+/* Start recording the next batch, only waits if every batch is still in flight */
+static VkResult begin_batch(vkcomp *app, uint32_t cur_ld, dlu_vk_uploader *up) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = app->ld_data[cur_ld].device;
+  struct upload_batch *batch = get_batch(up, up->next_ticket);
+
+  if (batch->ticket) {
+    res = vkWaitForFences(device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences"); return res; }
+
+    res = vkResetFences(device, 1, &batch->fence);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkResetFences"); return res; }
+  }
+
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  /* Command pools were created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, begin resets them */
+  res = vkBeginCommandBuffer(batch->xfer, &begin_info);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); return res; }
+
+  if (up->ownership) {
+    res = vkBeginCommandBuffer(batch->acquire, &begin_info);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkBeginCommandBuffer"); return res; }
+  }
+
+  batch->head = 0;
+  batch->ticket = up->next_ticket;
+  batch->recording = true;
+
+  return res;
+}
+
+/**
+* Make room for size bytes in the recording batch's staging buffer, submitting it and
+* moving on to the next batch when it's full. Returns the batch, NULL on failure
+*/
+static struct upload_batch *reserve(vkcomp *app, uint32_t cur_ld, dlu_vk_uploader *up, VkDeviceSize size) {
+  struct upload_batch *batch = get_batch(up, up->next_ticket);
+
+  if (batch->recording && batch->head && (batch->head + size) > batch->size)
+    if (dlu_vk_upload_submit(app, cur_ld, NULL)) return NULL;
+
+  batch = get_batch(up, up->next_ticket);
+  if (!batch->recording && begin_batch(app, cur_ld, up)) return NULL;
+
+  /* An upload larger than the staging buffer gets a staging buffer of its own size */
+  if (size > batch->size) {
+    destroy_staging(app, cur_ld, batch);
+    if (create_staging(app, cur_ld, batch, (size > up->staging_size) ? size : up->staging_size)) return NULL;
+  }
+
+  return batch;
+}
+
+/**
+* Copy data to the end of the staging buffer and flush it if the memory isn't host coherent.
+* The bytes only count as used once that worked, offset is where they start
+*/
+static VkResult stage(vkcomp *app, uint32_t cur_ld, struct upload_batch *batch, VkDeviceSize size, const void *data, VkDeviceSize *offset) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+
+  memcpy((char *) batch->sub.map + batch->head, data, size);
+  res = dlu_vk_mem_sync(app->ld_data[cur_ld].device, batch->mem, &batch->sub, batch->head, size, true);
+  if (res) return res;
+
+  *offset = batch->head;
+  batch->head = (batch->head + size + STAGING_ALIGN - 1) & ~((VkDeviceSize) STAGING_ALIGN - 1);
+
+  return res;
+}
+
+VkResult dlu_vk_upload_create(vkcomp *app, uint32_t cur_ld, VkDeviceSize staging_size) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = app->ld_data[cur_ld].device;
+  struct _pd_data *pd = &app->pd_data[app->ld_data[cur_ld].pdi];
+  dlu_vk_uploader *up = NULL;
+
+  if (!device) { PERR(DLU_VKCOMP_DEVICE, 0, NULL); return res; }
+  if (app->ld_data[cur_ld].upload) { PERR(DLU_ALREADY_ALLOC, 0, NULL); return res; }
+
+  up = calloc(1, sizeof(dlu_vk_uploader));
+  if (!up) { dlu_log_me(DLU_DANGER, "[x] calloc: %s", strerror(errno)); return res; }
+  app->ld_data[cur_ld].upload = up;
+
+  up->gfam_idx = pd->gfam_idx;
+  up->gfx_queue = app->ld_data[cur_ld].graphics;
+  up->staging_size = staging_size;
+  up->next_ticket = 1;
+
+  /* Without a transfer queue from a family of its own, uploads go through the graphics queue */
+  up->ownership = (app->ld_data[cur_ld].transfer && pd->tfam_idx != UINT32_MAX && pd->tfam_idx != pd->gfam_idx);
+  up->xfam_idx = (up->ownership) ? pd->tfam_idx : pd->gfam_idx;
+  up->xfer_queue = (up->ownership) ? app->ld_data[cur_ld].transfer : up->gfx_queue;
+
+  VkCommandPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  pool_info.pNext = NULL;
+  pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  pool_info.queueFamilyIndex = up->xfam_idx;
+
+  res = vkCreateCommandPool(device, &pool_info, app->vk_alloc, &up->xfer_pool);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateCommandPool"); goto finish_upload; }
+
+  if (up->ownership) {
+    pool_info.queueFamilyIndex = up->gfam_idx;
+    res = vkCreateCommandPool(device, &pool_info, app->vk_alloc, &up->acquire_pool);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateCommandPool"); goto finish_upload; }
+  }
+
+  VkCommandBufferAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  alloc_info.pNext = NULL;
+  alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  alloc_info.commandBufferCount = 1;
+
+  VkFenceCreateInfo fence_info = {};
+  fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  fence_info.pNext = NULL;
+
+  VkSemaphoreCreateInfo sem_info = {};
+  sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  sem_info.pNext = NULL;
+
+  for (uint32_t i = 0; i < DLU_VK_UPLOAD_BATCH_CNT; i++) {
+    struct upload_batch *batch = &up->batches[i];
+
+    alloc_info.commandPool = up->xfer_pool;
+    res = vkAllocateCommandBuffers(device, &alloc_info, &batch->xfer);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateCommandBuffers"); goto finish_upload; }
+
+    res = vkCreateFence(device, &fence_info, app->vk_alloc, &batch->fence);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateFence"); goto finish_upload; }
+
+    if (staging_size) {
+      res = create_staging(app, cur_ld, batch, staging_size);
+      if (res) goto finish_upload;
+    }
+
+    if (!up->ownership) continue;
+
+    alloc_info.commandPool = up->acquire_pool;
+    res = vkAllocateCommandBuffers(device, &alloc_info, &batch->acquire);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkAllocateCommandBuffers"); goto finish_upload; }
+
+    res = vkCreateSemaphore(device, &sem_info, app->vk_alloc, &batch->sem);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateSemaphore"); goto finish_upload; }
+  }
+
+  return res;
+
+finish_upload:
+  dlu_vk_upload_destroy(app, cur_ld);
+  return res;
+}
+
+void dlu_vk_upload_destroy(vkcomp *app, uint32_t cur_ld) {
+  dlu_vk_uploader *up = app->ld_data[cur_ld].upload;
+  VkDevice device = app->ld_data[cur_ld].device;
+  if (!up) return;
+
+  for (uint32_t i = 0; i < DLU_VK_UPLOAD_BATCH_CNT; i++) {
+    struct upload_batch *batch = &up->batches[i];
+
+    /* A batch still being recorded was never submitted, its fence would never signal */
+    if (batch->ticket && !batch->recording)
+      vkWaitForFences(device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+
+    destroy_staging(app, cur_ld, batch);
+    if (batch->fence) vkDestroyFence(device, batch->fence, app->vk_alloc);
+    if (batch->sem) vkDestroySemaphore(device, batch->sem, app->vk_alloc);
+  }
+
+  /* Command buffers are freed with their pools */
+  if (up->xfer_pool) vkDestroyCommandPool(device, up->xfer_pool, app->vk_alloc);
+  if (up->acquire_pool) vkDestroyCommandPool(device, up->acquire_pool, app->vk_alloc);
+
+  free(up);
+  app->ld_data[cur_ld].upload = NULL;
+}
+
+VkResult dlu_vk_upload_buffer(
+  vkcomp *app,
+  uint32_t cur_ld,
+  uint32_t cur_bd,
+  VkDeviceSize offset,
+  VkDeviceSize size,
+  const void *data,
+  VkPipelineStageFlags dst_stage,
+  VkAccessFlags dst_access,
+  uint64_t *ticket
+) {
+
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_uploader *up = app->ld_data[cur_ld].upload;
+  struct upload_batch *batch = NULL;
+  VkDeviceSize src_offset = 0;
+
+  if (!up) { PERR(DLU_VKCOMP_UPLOAD, 0, NULL); return res; }
+  if (!app->buff_data[cur_bd].buff) { PERR(DLU_VKCOMP_BUFF_MEM, 0, NULL); return res; }
+
+  batch = reserve(app, cur_ld, up, size);
+  if (!batch) return res;
+
+  res = stage(app, cur_ld, batch, size, data, &src_offset);
+  if (res) return res;
+
+  VkBufferCopy copy_region = {};
+  copy_region.srcOffset = src_offset;
+  copy_region.dstOffset = offset;
+  copy_region.size = size;
+
+  vkCmdCopyBuffer(batch->xfer, batch->staging, app->buff_data[cur_bd].buff, 1, &copy_region);
+
+  VkBufferMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.pNext = NULL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = dst_access;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer = app->buff_data[cur_bd].buff;
+  barrier.offset = offset;
+  barrier.size = size;
+
+  if (!up->ownership) {
+    vkCmdPipelineBarrier(batch->xfer, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage, 0, 0, NULL, 1, &barrier, 0, NULL);
+  } else {
+    /* Release from the transfer family, the destination access mask is ignored */
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = up->xfam_idx;
+    barrier.dstQueueFamilyIndex = up->gfam_idx;
+    vkCmdPipelineBarrier(batch->xfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+
+    /* Acquire on the graphics family, the source access mask is ignored */
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dst_access;
+    vkCmdPipelineBarrier(batch->acquire, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dst_stage, 0, 0, NULL, 1, &barrier, 0, NULL);
+  }
+
+  if (ticket) *ticket = batch->ticket;
+
+  return res;
+}
+
+VkResult dlu_vk_upload_image(
+  vkcomp *app,
+  uint32_t cur_ld,
+  uint32_t cur_tex,
+  VkDeviceSize size,
+  const void *data,
+  VkExtent3D extent,
+  VkImageSubresourceRange sub_rr,
+  VkImageLayout final_layout,
+  VkPipelineStageFlags dst_stage,
+  VkAccessFlags dst_access,
+  uint64_t *ticket
+) {
+
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_uploader *up = app->ld_data[cur_ld].upload;
+  struct upload_batch *batch = NULL;
+  VkDeviceSize src_offset = 0;
+
+  if (!up) { PERR(DLU_VKCOMP_UPLOAD, 0, NULL); return res; }
+  if (!app->text_data[cur_tex].image) { PERR(DLU_VKCOMP_BUFF_MEM, 0, NULL); return res; }
+
+  batch = reserve(app, cur_ld, up, size);
+  if (!batch) return res;
+
+  res = stage(app, cur_ld, batch, size, data, &src_offset);
+  if (res) return res;
+
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.pNext = NULL;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = app->text_data[cur_tex].image;
+  barrier.subresourceRange = sub_rr;
+
+  vkCmdPipelineBarrier(batch->xfer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+  VkBufferImageCopy region = {};
+  region.bufferOffset = src_offset;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageSubresource.aspectMask = sub_rr.aspectMask;
+  region.imageSubresource.mipLevel = sub_rr.baseMipLevel;
+  region.imageSubresource.baseArrayLayer = sub_rr.baseArrayLayer;
+  region.imageSubresource.layerCount = sub_rr.layerCount;
+  region.imageExtent = extent;
+
+  vkCmdCopyBufferToImage(batch->xfer, batch->staging, app->text_data[cur_tex].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  /* Last transition into final_layout, doubles as the ownership transfer */
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = dst_access;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = final_layout;
+
+  if (!up->ownership) {
+    vkCmdPipelineBarrier(batch->xfer, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+  } else {
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = up->xfam_idx;
+    barrier.dstQueueFamilyIndex = up->gfam_idx;
+    vkCmdPipelineBarrier(batch->xfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+    /* The acquire must repeat the same layout transition */
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dst_access;
+    vkCmdPipelineBarrier(batch->acquire, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+  }
+
+  if (ticket) *ticket = batch->ticket;
+
+  return res;
+}
+
+/**
+* The transfer submission went through, the acquire one didn't. Have the transfer queue
+* wait on the semaphore and signal the fence, so the batch still finishes before its staging
+* buffer is reused. If even that fails wait for the queue to go idle, the semaphore stays
+* signaled then and is replaced
+*/
+static void drop_acquire(vkcomp *app, uint32_t cur_ld, dlu_vk_uploader *up, struct upload_batch *batch) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  VkDevice device = app->ld_data[cur_ld].device;
+  VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.waitSemaphoreCount = 1;
+  submit_info.pWaitSemaphores = &batch->sem;
+  submit_info.pWaitDstStageMask = &wait_stage;
+
+  res = vkQueueSubmit(up->xfer_queue, 1, &submit_info, batch->fence);
+  if (!res) return;
+  PERR(DLU_VK_FUNC_ERR, res, "vkQueueSubmit");
+
+  res = vkQueueWaitIdle(up->xfer_queue);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkQueueWaitIdle");
+
+  /* The fence never signals, nothing should wait on it */
+  batch->ticket = 0;
+
+  VkSemaphoreCreateInfo sem_info = {};
+  sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  sem_info.pNext = NULL;
+
+  vkDestroySemaphore(device, batch->sem, app->vk_alloc);
+  res = vkCreateSemaphore(device, &sem_info, app->vk_alloc, &batch->sem);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkCreateSemaphore"); batch->sem = VK_NULL_HANDLE; }
+}
+
+VkResult dlu_vk_upload_submit(vkcomp *app, uint32_t cur_ld, uint64_t *ticket) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_uploader *up = app->ld_data[cur_ld].upload;
+  struct upload_batch *batch = NULL;
+
+  if (!up) { PERR(DLU_VKCOMP_UPLOAD, 0, NULL); return res; }
+
+  /* Nothing recorded, the last submitted batch is the newest */
+  batch = get_batch(up, up->next_ticket);
+  if (!batch->recording) {
+    if (ticket) *ticket = up->next_ticket - 1;
+    return VK_SUCCESS;
+  }
+
+  res = vkEndCommandBuffer(batch->xfer);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkEndCommandBuffer"); goto err_drop; }
+
+  VkSubmitInfo submit_info = {};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.pNext = NULL;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &batch->xfer;
+  submit_info.signalSemaphoreCount = (up->ownership) ? 1 : 0;
+  submit_info.pSignalSemaphores = &batch->sem;
+
+  res = vkQueueSubmit(up->xfer_queue, 1, &submit_info, (up->ownership) ? VK_NULL_HANDLE : batch->fence);
+  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkQueueSubmit"); goto err_drop; }
+
+  if (up->ownership) {
+    res = vkEndCommandBuffer(batch->acquire);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkEndCommandBuffer"); goto err_acquire; }
+
+    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    submit_info.waitSemaphoreCount = 1;
+    submit_info.pWaitSemaphores = &batch->sem;
+    submit_info.pWaitDstStageMask = &wait_stage;
+    submit_info.pCommandBuffers = &batch->acquire;
+    submit_info.signalSemaphoreCount = 0;
+    submit_info.pSignalSemaphores = NULL;
+
+    res = vkQueueSubmit(up->gfx_queue, 1, &submit_info, batch->fence);
+    if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkQueueSubmit"); goto err_acquire; }
+  }
+
+  batch->recording = false;
+  if (ticket) *ticket = batch->ticket;
+  up->next_ticket++;
+
+  return res;
+
+err_acquire:
+  /* The batch's ticket is spent, its resources never changed owner */
+  drop_acquire(app, cur_ld, up, batch);
+  batch->recording = false;
+  up->next_ticket++;
+  return res;
+
+err_drop:
+  /**
+  * Nothing was submitted and the batch's uploads are lost. The slot is recorded again from
+  * scratch under the same ticket, its fence was reset by begin_batch() and never waited on
+  */
+  if (up->ownership) vkResetCommandBuffer(batch->acquire, 0);
+  batch->recording = false;
+  batch->ticket = 0;
+  return res;
+}
+
+bool dlu_vk_upload_done(vkcomp *app, uint32_t cur_ld, uint64_t ticket) {
+  dlu_vk_uploader *up = app->ld_data[cur_ld].upload;
+  struct upload_batch *batch = NULL;
+
+  if (!up || !ticket) return true;
+  if (ticket >= up->next_ticket) return false;
+
+  /* The batch's slot was reused, it must have finished first */
+  batch = get_batch(up, ticket);
+  if (batch->ticket != ticket) return true;
+
+  return vkGetFenceStatus(app->ld_data[cur_ld].device, batch->fence) == VK_SUCCESS;
+}
+
+VkResult dlu_vk_upload_wait(vkcomp *app, uint32_t cur_ld, uint64_t ticket) {
+  VkResult res = VK_RESULT_MAX_ENUM;
+  dlu_vk_uploader *up = app->ld_data[cur_ld].upload;
+  struct upload_batch *batch = NULL;
+
+  if (!up) { PERR(DLU_VKCOMP_UPLOAD, 0, NULL); return res; }
+  if (!ticket || ticket > up->next_ticket) return VK_SUCCESS;
+
+  if (ticket == up->next_ticket) {
+    res = dlu_vk_upload_submit(app, cur_ld, NULL);
+    if (res) return res;
+  }
+
+  batch = get_batch(up, ticket);
+  if (batch->ticket != ticket) return VK_SUCCESS;
+
+  res = vkWaitForFences(app->ld_data[cur_ld].device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkWaitForFences");
+
+  return res;
+}
@@ -70,79 +70,139 @@ void dlu_vk_destroy(dlu_destroy_type type, vkcomp *app, uint32_t cur_ld, void *d
   switch (type) {
       case DLU_DESTROY_VK_SHADER:
         {VkShaderModule shader_module = (VkShaderModule) data;
-         if (shader_module) vkDestroyShaderModule(app->ld_data[cur_ld].device, shader_module, NULL);}
+         if (shader_module) vkDestroyShaderModule(app->ld_data[cur_ld].device, shader_module, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_BUFFER:
         {VkBuffer buff = (VkBuffer) data;
-         if (buff) vkDestroyBuffer(app->ld_data[cur_ld].device, buff, NULL);}
+         if (buff) vkDestroyBuffer(app->ld_data[cur_ld].device, buff, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_MEMORY:
         {VkDeviceMemory mem = (VkDeviceMemory) data;
-         if (mem) vkFreeMemory(app->ld_data[cur_ld].device, mem, NULL);}
+         /* Other resources live in pool blocks, ranges are released with dlu_vk_mem_free() */
+         if (dlu_vk_mem_is_pooled(app, cur_ld, mem)) { PERR(DLU_OP_NOT_PERMITED, 0, NULL); break; }
+         if (mem) vkFreeMemory(app->ld_data[cur_ld].device, mem, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_CMD_POOL:
         {VkCommandPool pool = (VkCommandPool) data; 
-         if (pool) vkDestroyCommandPool(app->ld_data[cur_ld].device, pool, NULL);}
+         if (pool) vkDestroyCommandPool(app->ld_data[cur_ld].device, pool, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_DESC_POOL:
         {VkDescriptorPool pool = (VkDescriptorPool) data; 
-         if (pool) vkDestroyDescriptorPool(app->ld_data[cur_ld].device, pool, NULL);}
+         if (pool) vkDestroyDescriptorPool(app->ld_data[cur_ld].device, pool, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_DESC_SET_LAYOUT:
         {VkDescriptorSetLayout layout = (VkDescriptorSetLayout) data;
-         if (layout) vkDestroyDescriptorSetLayout(app->ld_data[cur_ld].device, layout, NULL);}
+         if (layout) vkDestroyDescriptorSetLayout(app->ld_data[cur_ld].device, layout, app->vk_alloc);}
         break;
       case DLU_DESTROY_PIPELINE_CACHE:
         {VkPipelineCache cache = (VkPipelineCache) data;
-         if (cache) vkDestroyPipelineCache(app->ld_data[cur_ld].device, cache, NULL);}
+         if (cache) vkDestroyPipelineCache(app->ld_data[cur_ld].device, cache, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_FRAME_BUFFER:
         {VkFramebuffer frame = (VkFramebuffer) data;
-         if (frame) vkDestroyFramebuffer(app->ld_data[cur_ld].device, frame, NULL);}
+         if (frame) vkDestroyFramebuffer(app->ld_data[cur_ld].device, frame, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_RENDER_PASS:
         {VkRenderPass rp = (VkRenderPass) data;
-         if (rp) vkDestroyRenderPass(app->ld_data[cur_ld].device, rp, NULL);}
+         if (rp) vkDestroyRenderPass(app->ld_data[cur_ld].device, rp, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_PIPE_LAYOUT:
         {VkPipelineLayout pipe_layout = (VkPipelineLayout) data;
-         if (pipe_layout) vkDestroyPipelineLayout(app->ld_data[cur_ld].device, pipe_layout, NULL);}
+         if (pipe_layout) vkDestroyPipelineLayout(app->ld_data[cur_ld].device, pipe_layout, app->vk_alloc);}
         break;
       case DLU_DESTROY_PIPELINE:
         {VkPipeline pipeline = (VkPipeline) data;
-         if (pipeline) vkDestroyPipeline(app->ld_data[cur_ld].device, pipeline, NULL);}
+         if (pipeline) vkDestroyPipeline(app->ld_data[cur_ld].device, pipeline, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_SAMPLER:
         {VkSampler sampler = (VkSampler) data;
-         if (sampler) vkDestroySampler(app->ld_data[cur_ld].device, sampler, NULL);}
+         if (sampler) vkDestroySampler(app->ld_data[cur_ld].device, sampler, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_IMAGE:
         {VkImage image = (VkImage) data;
-         if (image) vkDestroyImage(app->ld_data[cur_ld].device, image, NULL);}
+         if (image) vkDestroyImage(app->ld_data[cur_ld].device, image, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_IMAGE_VIEW:
         {VkImageView view = (VkImageView) data;
-         if (view) vkDestroyImageView(app->ld_data[cur_ld].device, view, NULL);}
+         if (view) vkDestroyImageView(app->ld_data[cur_ld].device, view, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_SWAPCHAIN:
         {VkSwapchainKHR swapchain = (VkSwapchainKHR) data;
-         if (swapchain) vkDestroySwapchainKHR(app->ld_data[cur_ld].device, swapchain, NULL);}
+         if (swapchain) vkDestroySwapchainKHR(app->ld_data[cur_ld].device, swapchain, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_SEMAPHORE:
         {VkSemaphore semaphore = (VkSemaphore) data;
-         if (semaphore) vkDestroySemaphore(app->ld_data[cur_ld].device, semaphore, NULL);}
+         if (semaphore) vkDestroySemaphore(app->ld_data[cur_ld].device, semaphore, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_FENCE:
         {VkFence fence = (VkFence) data;
-         if (fence) vkDestroyFence(app->ld_data[cur_ld].device, fence, NULL);}
+         if (fence) vkDestroyFence(app->ld_data[cur_ld].device, fence, app->vk_alloc);}
         break;
       case DLU_DESTROY_VK_LOGIC_DEVICE:
-         if (app->ld_data[cur_ld].device) vkDestroyDevice(app->ld_data[cur_ld].device, NULL);
+         dlu_vk_upload_destroy(app, cur_ld);
+         dlu_vk_bindless_destroy(app, cur_ld);
+         dlu_vk_timeline_destroy(app, cur_ld);
+         dlu_vk_profiler_destroy(app, cur_ld);
+         dlu_vk_mem_pool_destroy(app, cur_ld);
+         if (app->ld_data[cur_ld].device) vkDestroyDevice(app->ld_data[cur_ld].device, app->vk_alloc);
         break;
       default: break;
   }
 }
 
+/* Find the device and the pool range a buffer or image was bound to */
+static dlu_vk_suballoc *get_suballoc(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDevice *device, VkDeviceMemory *mem) {
+  dlu_vk_suballoc *sub = NULL;
+
+  switch (type) {
+    case DLU_VK_BUFFER:
+      *device = app->ld_data[app->buff_data[cur_idx].ldi].device;
+      *mem = app->buff_data[cur_idx].mem;
+      sub = &app->buff_data[cur_idx].sub;
+      break;
+    case DLU_TEXT_VK_IMAGE:
+      *device = app->ld_data[app->text_data[cur_idx].ldi].device;
+      *mem = app->text_data[cur_idx].mem;
+      sub = &app->text_data[cur_idx].sub;
+      break;
+    default: return NULL;
+  }
+
+  if (!(*mem)) { PERR(DLU_VKCOMP_BUFF_MEM, 0, NULL); return NULL; }
+  if (!sub->map) { PERR(DLU_VKCOMP_MEM_NOT_MAPPED, 0, NULL); return NULL; }
+
+  return sub;
+}
+
+void *dlu_vk_get_mapped(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset) {
+  VkDevice device = VK_NULL_HANDLE;
+  VkDeviceMemory mem = VK_NULL_HANDLE;
+
+  dlu_vk_suballoc *sub = get_suballoc(type, app, cur_idx, &device, &mem);
+  if (!sub) return NULL;
+
+  /* offset is relative to the resource, sub->map already points to its range */
+  return (char *) sub->map + offset;
+}
+
+static VkResult sync_mapped(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset, VkDeviceSize size, bool flush) {
+  VkDevice device = VK_NULL_HANDLE;
+  VkDeviceMemory mem = VK_NULL_HANDLE;
+
+  dlu_vk_suballoc *sub = get_suballoc(type, app, cur_idx, &device, &mem);
+  if (!sub) return VK_RESULT_MAX_ENUM;
+
+  return dlu_vk_mem_sync(device, mem, sub, offset, size, flush);
+}
+
+VkResult dlu_vk_flush_mem(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset, VkDeviceSize size) {
+  return sync_mapped(type, app, cur_idx, offset, size, true);
+}
+
+VkResult dlu_vk_invalidate_mem(dlu_mem_map_type type, vkcomp *app, uint32_t cur_idx, VkDeviceSize offset, VkDeviceSize size) {
+  return sync_mapped(type, app, cur_idx, offset, size, false);
+}
+
 VkResult dlu_vk_map_mem(
   dlu_mem_map_type type,
   vkcomp *app,
@@ -153,49 +213,14 @@ VkResult dlu_vk_map_mem(
   VkMemoryMapFlags flags
 ) {
 
-  VkResult res = VK_RESULT_MAX_ENUM;
-  VkDevice device = VK_NULL_HANDLE;
-  VkDeviceMemory mem = VK_NULL_HANDLE;
+  /* Host visible memory is mapped once when allocated, see dlu_vk_mem_alloc(3) */
+  (void) flags;
 
-  switch (type) {
-    case DLU_VK_BUFFER:
-      if (!app->buff_data[cur_idx].mem) { PERR(DLU_VKCOMP_BUFF_MEM, 0, NULL); return res; }
-      device = app->ld_data[app->buff_data[cur_idx].ldi].device;
-      mem = app->buff_data[cur_idx].mem;
-      break;
-    case DLU_TEXT_VK_IMAGE:
-      if (!app->text_data[cur_idx].mem) { PERR(DLU_VKCOMP_BUFF_MEM, 0, NULL); return res; }
-      device = app->ld_data[app->text_data[cur_idx].ldi].device;
-      mem = app->text_data[cur_idx].mem;
-      break;
-    default: break;
-  }
+  void *p_data = dlu_vk_get_mapped(type, app, cur_idx, offset);
+  if (!p_data) return VK_RESULT_MAX_ENUM;
 
-  /**
-  * Can Find in vulkan SDK doc/tutorial/html/07-init_uniform_buffer.html
-  * With any buffer, you need to populate it with the data that
-  * you want the shader to read. In order to get CPU access to
-  * the memory, you need to map it
-  */
-  void *p_data = NULL;
-  res = vkMapMemory(device, mem, offset, size, flags, &p_data);
-  if (res) { PERR(DLU_VK_FUNC_ERR, res, "vkMapMemory"); return res; }
   memmove(p_data, data, size);
 
   /* flush the mapped memory to tell the driver which parts of VkDeviceMemory were modified */
-  /*
-  VkMappedMemoryRange range = {};
-  range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-  range.pNext = NULL;
-  range.memory = mem;
-  range.offset = offset;
-  range.size = size;
-
-  res = vkFlushMappedMemoryRanges(device, 1, &range);
-  if (res) PERR(DLU_VK_FUNC_ERR, res, "vkFlushMappedMemoryRanges");
-  */
-
-  vkUnmapMemory(device, mem);
-
-  return res;
+  return dlu_vk_flush_mem(type, app, cur_idx, offset, size);
 }
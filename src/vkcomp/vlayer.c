@@ -202,7 +202,7 @@ VkResult dlu_set_debug_message(
   * Create the debug utils message object this allows for the detected validation errors
   * and warnings to be exposed by debug_report_callbackFN.
   */
-  res = dbg_create_utils_msg(app->instance, &create_info, NULL, &app->debug_utils_msg);
+  res = dbg_create_utils_msg(app->instance, &create_info, app->vk_alloc, &app->debug_utils_msg);
   if (res) PERR(DLU_VK_FUNC_ERR, res, "vkCreateDebugUtilsMessengerEXT");
 
   return res;
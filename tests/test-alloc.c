@@ -22,8 +22,14 @@
 * THE SOFTWARE.
 */
 
+#define LUCUR_VKCOMP_API
 #include <lucom.h>
 #include <check.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#define THREAD_COUNT 4
+#define THREAD_ALLOCS 64
 
 START_TEST(basic_priv_alloc) {
   dlu_otma_mems ma = {
@@ -81,6 +87,492 @@ START_TEST(basic_shared_alloc) {
   bytes=NULL; q=NULL;
 } END_TEST;
 
+static void *arena_thread(void *data) {
+  dlu_block_type type = *((dlu_block_type *) data);
+
+  dlu_arena *arena = dlu_arena_create(type, THREAD_ALLOCS * (sizeof(int) + 64));
+  if (!arena) return NULL;
+
+  dlu_arena_bind(arena);
+
+  int *ints[THREAD_ALLOCS];
+  for (int i = 0; i < THREAD_ALLOCS; i++) {
+    ints[i] = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int));
+    if (!ints[i]) return NULL;
+    *ints[i] = i;
+  }
+
+  for (int i = 0; i < THREAD_ALLOCS; i++)
+    if (*ints[i] != i) return NULL;
+
+  dlu_arena_destroy(arena);
+  return arena;
+}
+
+START_TEST(thread_arena_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = THREAD_COUNT * THREAD_ALLOCS * 64 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  pthread_t threads[THREAD_COUNT];
+  dlu_block_type types[THREAD_COUNT];
+  void *ret = NULL;
+
+  /* Half the threads carve from the dlu_otma block the other half map their own */
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    types[i] = (i % 2) ? DLU_SMALL_BLOCK_PRIV : DLU_LARGE_BLOCK_PRIV;
+    ck_assert_int_eq(pthread_create(&threads[i], NULL, arena_thread, &types[i]), 0);
+  }
+
+  /* Main thread keeps using the process wide block */
+  int *bytes = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int));
+  ck_assert_ptr_nonnull(bytes);
+  *bytes = 30;
+
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    ck_assert_int_eq(pthread_join(threads[i], &ret), 0);
+    ck_assert_ptr_nonnull(ret);
+  }
+
+  ck_assert_int_eq(*bytes, 30);
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(chained_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 1, .flags = DLU_BLOCK_CHAINED };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  /* Go well passed the first chunk */
+  int *ints[1024];
+  for (int i = 0; i < 1024; i++) {
+    ints[i] = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(int));
+    ck_assert_ptr_nonnull(ints[i]);
+    ints[i][0] = ints[i][63] = i;
+  }
+
+  /* Allocation larger than a doubled chunk */
+  char *large = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 1 << 24);
+  ck_assert_ptr_nonnull(large);
+  large[(1 << 24) - 1] = 'a';
+
+  for (int i = 0; i < 1024; i++)
+    ck_assert(ints[i][0] == i && ints[i][63] == i);
+
+  dlu_release_blocks();
+
+  /* Without the flag the block is not grown */
+  ma.flags = 0;
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+  ck_assert_ptr_null(dlu_alloc(DLU_SMALL_BLOCK_PRIV, 1 << 24));
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(free_realloc_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 4096 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  /* Released blocks are reused by requests of the same size class */
+  int *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(int));
+  int *b = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  ck_assert_ptr_nonnull(b);
+  dlu_free(DLU_SMALL_BLOCK_PRIV, a);
+  ck_assert_ptr_eq(dlu_alloc(DLU_SMALL_BLOCK_PRIV, 60 * sizeof(int)), a);
+
+  /* Churn far passed what the block holds without exhausting it */
+  for (int i = 0; i < 10000; i++) {
+    int *c = dlu_alloc(DLU_SMALL_BLOCK_PRIV, ((i % 8) + 1) * 32 * sizeof(int));
+    ck_assert_ptr_nonnull(c);
+    ck_assert_int_eq(c[0], 0);
+    c[0] = i;
+    dlu_free(DLU_SMALL_BLOCK_PRIV, c);
+  }
+
+  /* Growing keeps data and zeroes the new bytes */
+  b[0] = 30; b[63] = 40;
+  b = dlu_realloc(DLU_SMALL_BLOCK_PRIV, b, 128 * sizeof(int));
+  ck_assert_ptr_nonnull(b);
+  ck_assert_int_eq(b[0], 30);
+  ck_assert_int_eq(b[63], 40);
+  ck_assert_int_eq(b[127], 0);
+
+  /* Last allocated block grows in place */
+  dlu_arena *arena = dlu_arena_create(DLU_SMALL_BLOCK_PRIV, 4096);
+  ck_assert_ptr_nonnull(arena);
+  int *d = dlu_arena_alloc(arena, sizeof(int));
+  ck_assert_ptr_eq(dlu_arena_realloc(arena, d, 16 * sizeof(int)), d);
+  dlu_arena_destroy(arena);
+
+  /* Destroyed arena's memory went back to the block */
+  arena = dlu_arena_create(DLU_SMALL_BLOCK_PRIV, 4096);
+  ck_assert_ptr_nonnull(arena);
+  dlu_arena_destroy(arena);
+
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(bin_churn_alloc) {
+  dlu_otma_mems ma = { .cha_cnt = 1 << 16 };
+  dlu_mem_stats stats;
+
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  /* Sizes that aren't a class size on their own, warm up the free lists first */
+  char *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 100);
+  char *b = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 1000);
+  ck_assert_ptr_nonnull(a);
+  ck_assert_ptr_nonnull(b);
+  dlu_free(DLU_SMALL_BLOCK_PRIV, a);
+  dlu_free(DLU_SMALL_BLOCK_PRIV, b);
+
+  ck_assert(dlu_get_mem_stats(DLU_LARGE_BLOCK_PRIV, &stats));
+  size_t used = stats.used, peak = stats.peak;
+
+  /* Every later request must be served by a released block */
+  for (int i = 0; i < 1000; i++) {
+    a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 100);
+    b = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 1000);
+    ck_assert_ptr_nonnull(a);
+    ck_assert_ptr_nonnull(b);
+    ck_assert_int_eq(a[99], 0);
+    ck_assert_int_eq(b[999], 0);
+    a[99] = b[999] = 1;
+    dlu_free(DLU_SMALL_BLOCK_PRIV, b);
+    dlu_free(DLU_SMALL_BLOCK_PRIV, a);
+
+    ck_assert(dlu_get_mem_stats(DLU_LARGE_BLOCK_PRIV, &stats));
+    ck_assert_int_eq(stats.used, used);
+    ck_assert_int_eq(stats.peak, peak);
+  }
+
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(realloc_shrink_grow_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 1024 };
+
+  for (int mode = 0; mode < 2; mode++) {
+    ma.flags = (mode) ? DLU_BLOCK_HEADERLESS : 0;
+    if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+    int *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(int));
+    ck_assert_ptr_nonnull(a);
+    for (int i = 0; i < 64; i++) a[i] = i + 1;
+
+    /* Too small a shrink to split the block off, it stays in place */
+    ck_assert_ptr_eq(dlu_realloc(DLU_SMALL_BLOCK_PRIV, a, 60 * sizeof(int)), a);
+
+    /* Growing back must not hand out the bytes dropped by the shrink */
+    ck_assert_ptr_eq(dlu_realloc(DLU_SMALL_BLOCK_PRIV, a, 64 * sizeof(int)), a);
+    for (int i = 0; i < 60; i++) ck_assert_int_eq(a[i], i + 1);
+    for (int i = 60; i < 64; i++) ck_assert_int_eq(a[i], 0);
+
+    dlu_release_blocks();
+  }
+} END_TEST;
+
+START_TEST(headerless_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 1024, .flags = DLU_BLOCK_HEADERLESS };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  /* Small blocks are packed without metadata in between */
+  int *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int));
+  int *b = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  ck_assert_ptr_nonnull(b);
+  ck_assert_ptr_eq((char *) b, (char *) a + 16);
+
+  /* Released blocks are reused and zeroed */
+  *a = 5;
+  dlu_free(DLU_SMALL_BLOCK_PRIV, a);
+  ck_assert_ptr_eq(dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int)), a);
+  ck_assert_int_eq(*a, 0);
+
+  /* Growing keeps data */
+  *b = 30;
+  b = dlu_realloc(DLU_SMALL_BLOCK_PRIV, b, 64 * sizeof(int));
+  ck_assert_ptr_nonnull(b);
+  ck_assert_int_eq(b[0], 30);
+  ck_assert_int_eq(b[63], 0);
+
+  /* Moving a block counts as one allocation and one release */
+  dlu_mem_stats stats;
+  ck_assert(dlu_get_mem_stats(DLU_LARGE_BLOCK_PRIV, &stats));
+  ck_assert_int_eq(stats.alloc_cnt, 4);
+  ck_assert_int_eq(stats.free_cnt, 2);
+
+  /* Blocks larger than the last size class can't be described */
+  ck_assert_ptr_null(dlu_alloc(DLU_SMALL_BLOCK_PRIV, 1 << 22));
+  dlu_release_blocks();
+
+  /* Header-less chunks can be chained */
+  ma.inta_cnt = 1;
+  ma.flags = DLU_BLOCK_HEADERLESS | DLU_BLOCK_CHAINED;
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  int *ints[1024];
+  for (int i = 0; i < 1024; i++) {
+    ints[i] = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(int));
+    ck_assert_ptr_nonnull(ints[i]);
+    ints[i][0] = ints[i][63] = i;
+  }
+
+  for (int i = 0; i < 1024; i++) {
+    ck_assert(ints[i][0] == i && ints[i][63] == i);
+    dlu_free(DLU_SMALL_BLOCK_PRIV, ints[i]);
+  }
+
+  dlu_release_blocks();
+
+  /* Arenas created once the blocks are released don't inherit their flags */
+  dlu_arena *arena = dlu_arena_create(DLU_LARGE_BLOCK_PRIV, 4096);
+  ck_assert_ptr_nonnull(arena);
+  a = dlu_arena_alloc(arena, sizeof(int));
+  b = dlu_arena_alloc(arena, sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  ck_assert_ptr_nonnull(b);
+  ck_assert_ptr_ne((char *) b, (char *) a + 16);
+  dlu_arena_destroy(arena);
+} END_TEST;
+
+START_TEST(align_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 1, .ala_cnt = 8, .ala_bytes = 64 * sizeof(float), .ala_align = 4096 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  /* Budgeted padding covers every aligned allocation */
+  int *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  for (int i = 0; i < 8; i++) {
+    float *f = dlu_alloc_aligned(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(float), 4096);
+    ck_assert_ptr_nonnull(f);
+    ck_assert(!((uintptr_t) f & 4095));
+    f[63] = 1.0f;
+  }
+
+  /* Only powers of two up to page size are honored */
+  ck_assert_ptr_null(dlu_alloc_aligned(DLU_SMALL_BLOCK_PRIV, sizeof(int), 48));
+  ck_assert_ptr_null(dlu_alloc_aligned(DLU_SMALL_BLOCK_PRIV, sizeof(int), 1 << 20));
+  dlu_release_blocks();
+
+  /* Same in header-less mode */
+  ma.flags = DLU_BLOCK_HEADERLESS;
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+  a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  for (int i = 0; i < 8; i++) {
+    float *f = dlu_alloc_aligned(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(float), 4096);
+    ck_assert_ptr_nonnull(f);
+    ck_assert(!((uintptr_t) f & 4095));
+    dlu_free(DLU_SMALL_BLOCK_PRIV, f);
+  }
+
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(frame_linear_alloc) {
+  dlu_frame_arena *fa = dlu_frame_arena_create(2, 1024);
+  ck_assert_ptr_nonnull(fa);
+
+  /* Frames in flight don't share memory */
+  int *a = dlu_frame_alloc(fa, 0, 100 * sizeof(int));
+  int *b = dlu_frame_alloc(fa, 1, 100 * sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  ck_assert_ptr_nonnull(b);
+  ck_assert_ptr_ne(a, b);
+  ck_assert(!((uintptr_t) dlu_frame_alloc(fa, 0, 1) & 15));
+  a[99] = 1; b[99] = 2;
+
+  /* Region exhausted until the frame is reset */
+  ck_assert_ptr_null(dlu_frame_alloc(fa, 0, 1024));
+  dlu_frame_reset(fa, 2); /* Frame index wraps to 0 */
+  ck_assert_ptr_eq(dlu_frame_alloc(fa, 0, 1024), a);
+  ck_assert_int_eq(b[99], 2);
+
+  /* Sizes that would wrap around when rounded or multiplied are rejected */
+  ck_assert_ptr_null(dlu_frame_alloc(fa, 1, SIZE_MAX));
+  ck_assert_ptr_null(dlu_frame_arena_create(2, SIZE_MAX));
+  ck_assert_ptr_null(dlu_frame_arena_create(4, SIZE_MAX / 2));
+
+  dlu_frame_arena_destroy(fa);
+} END_TEST;
+
+START_TEST(resident_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 4096, .flags = DLU_BLOCK_POPULATE | DLU_BLOCK_HUGE_PAGES | DLU_BLOCK_MLOCK };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  /* Huge page backed blocks still hand out zeroed memory */
+  int *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 4096 * sizeof(int));
+  ck_assert_ptr_nonnull(a);
+  ck_assert_int_eq(a[4095], 0);
+  a[4095] = 1;
+
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(memfd_shared_alloc) {
+  dlu_otma_mems ma = { .inta_cnt = 64 };
+  int sv[2];
+
+  if (!dlu_otma(DLU_LARGE_BLOCK_SHARED, ma)) ck_abort_msg(NULL);
+  ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+
+  int *a = dlu_alloc(DLU_SMALL_BLOCK_SHARED, 64 * sizeof(int));
+  ck_assert_ptr_nonnull(a);
+
+  /* Attach a second mapping of the block, like a client process would */
+  size_t bytes = 0;
+  ck_assert(dlu_export_shared_block(sv[0]));
+  void *addr = dlu_import_shared_block(sv[1], &bytes);
+  ck_assert_ptr_nonnull(addr);
+  ck_assert_uint_gt(bytes, dlu_shared_offset(a));
+
+  int *b = dlu_shared_ptr(addr, dlu_shared_offset(a));
+  ck_assert_ptr_ne(a, b);
+  b[63] = 7;
+  ck_assert_int_eq(a[63], 7);
+
+  /* A client overwriting everything it can reach doesn't corrupt the allocator */
+  dlu_free(DLU_SMALL_BLOCK_SHARED, a);
+  memset(addr, 0xff, bytes);
+  int *c = dlu_alloc(DLU_SMALL_BLOCK_SHARED, 64 * sizeof(int));
+  ck_assert_ptr_eq(c, a);
+  ck_assert_int_eq(c[63], 0);
+  dlu_free(DLU_SMALL_BLOCK_SHARED, c);
+  ck_assert_ptr_eq(dlu_alloc(DLU_SMALL_BLOCK_SHARED, 64 * sizeof(int)), a);
+  c = dlu_alloc(DLU_SMALL_BLOCK_SHARED, 64 * sizeof(int));
+  ck_assert_ptr_nonnull(c);
+  ck_assert_ptr_ne(c, a);
+  ck_assert_uint_lt(dlu_shared_offset(c), bytes);
+  /* Never handed out before, still bytes the client wrote to */
+  ck_assert_int_eq(c[0], 0);
+  ck_assert_int_eq(c[63], 0);
+
+  dlu_detach_shared_block(addr, bytes);
+  close(sv[0]); close(sv[1]);
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(mem_stats_alloc) {
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .pd_cnt = 128, .inta_cnt = 64 };
+  dlu_mem_stats stats;
+
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(vkcomp));
+  ck_assert_ptr_nonnull(app);
+  ck_assert(dlu_otba(DLU_PD_DATA, app, INDEX_IGNORE, 2));
+
+  int *a = dlu_alloc(DLU_SMALL_BLOCK_PRIV, 64 * sizeof(int));
+  ck_assert_ptr_nonnull(a);
+
+  ck_assert(dlu_get_mem_stats(DLU_LARGE_BLOCK_PRIV, &stats));
+  ck_assert_int_eq(stats.alloc_cnt, 3);
+  ck_assert_uint_ge(stats.otba_bytes[DLU_PD_DATA], 2 * sizeof(struct _pd_data));
+  ck_assert(stats.used > 64 * sizeof(int) && stats.used <= stats.reserved);
+  size_t used = stats.used;
+
+  /* Releasing lowers usage, but not the peak */
+  dlu_free(DLU_SMALL_BLOCK_PRIV, a);
+  ck_assert(dlu_get_mem_stats(DLU_LARGE_BLOCK_PRIV, &stats));
+  ck_assert_int_eq(stats.free_cnt, 1);
+  ck_assert(stats.used < used);
+  ck_assert_int_eq(stats.peak, used);
+
+  /* Array bytes follow the current size, not every size it had */
+  for (uint32_t i = 4; i <= 64; i *= 2)
+    ck_assert(dlu_otba(DLU_PD_DATA, app, INDEX_IGNORE, i));
+  ck_assert(dlu_get_mem_stats(DLU_LARGE_BLOCK_PRIV, &stats));
+  ck_assert_uint_ge(stats.otba_bytes[DLU_PD_DATA], 64 * sizeof(struct _pd_data));
+  ck_assert_uint_le(stats.otba_bytes[DLU_PD_DATA], 80 * sizeof(struct _pd_data));
+
+  dlu_print_mem_stats(DLU_LARGE_BLOCK_PRIV);
+  dlu_release_blocks();
+} END_TEST;
+
+START_TEST(otba_grow_alloc) {
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .bd_cnt = 8, .td_cnt = 2, .flags = DLU_BLOCK_CHAINED };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(vkcomp));
+  ck_assert_ptr_nonnull(app);
+
+  ck_assert(dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 2));
+  ck_assert_int_eq(app->bdc, 2);
+  app->buff_data[1].ldi = 0;
+
+  /* Smaller requests keep the array as is */
+  ck_assert(dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 1));
+  ck_assert_int_eq(app->bdc, 2);
+
+  /* Capacity doubles, old elements stay and new ones are initialized */
+  ck_assert(dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 3));
+  ck_assert_int_eq(app->bdc, 4);
+  ck_assert_int_eq(app->buff_data[1].ldi, 0);
+  ck_assert_int_eq(app->buff_data[3].ldi, UINT32_MAX);
+
+  ck_assert(dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 100));
+  ck_assert_int_eq(app->bdc, 100);
+  ck_assert_int_eq(app->buff_data[1].ldi, 0);
+  ck_assert_int_eq(app->buff_data[99].ldi, UINT32_MAX);
+
+  ck_assert(dlu_otba(DLU_TEXT_DATA, app, INDEX_IGNORE, 2));
+  ck_assert_int_eq(app->text_data[1].ldi, UINT32_MAX);
+
+  dlu_release_blocks();
+} END_TEST;
+
+static void *otba_bound_thread(void *data) {
+  vkcomp *app = data;
+
+  dlu_arena *arena = dlu_arena_create(DLU_LARGE_BLOCK_PRIV, 1 << 16);
+  if (!arena) return NULL;
+
+  dlu_arena_bind(arena);
+
+  /* Arrays grow in the process wide block even with an arena bound */
+  if (!dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 3)) return NULL;
+  if (!dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 100)) return NULL;
+  app->buff_data[99].ldi = 99;
+
+  /* Blocks of the process wide block are not the bound arena's to release */
+  dlu_free(DLU_SMALL_BLOCK_PRIV, app->buff_data);
+
+  int *bytes = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(int) * 512);
+  if (!bytes) return NULL;
+  memset(bytes, 0xff, sizeof(int) * 512);
+
+  dlu_arena_destroy(arena);
+  return app;
+}
+
+START_TEST(otba_bound_grow_alloc) {
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .bd_cnt = 8, .flags = DLU_BLOCK_CHAINED };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_alloc(DLU_SMALL_BLOCK_PRIV, sizeof(vkcomp));
+  ck_assert_ptr_nonnull(app);
+
+  ck_assert(dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 2));
+  app->buff_data[1].ldi = 1;
+
+  pthread_t thread;
+  void *ret = NULL;
+  ck_assert_int_eq(pthread_create(&thread, NULL, otba_bound_thread, app), 0);
+  ck_assert_int_eq(pthread_join(thread, &ret), 0);
+  ck_assert_ptr_nonnull(ret);
+
+  /* Bound arena is gone, the array must have outlived it untouched */
+  ck_assert_int_eq(app->bdc, 100);
+  ck_assert_int_eq(app->buff_data[1].ldi, 1);
+  ck_assert_int_eq(app->buff_data[2].ldi, UINT32_MAX);
+  ck_assert_int_eq(app->buff_data[99].ldi, 99);
+
+  /* Still owned by the process wide block */
+  ck_assert(dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 200));
+  ck_assert_int_eq(app->buff_data[99].ldi, 99);
+
+  dlu_release_blocks();
+} END_TEST;
+
 Suite *alloc_suite(void) {
   Suite *s = NULL;
   TCase *tc_core = NULL;
@@ -92,6 +584,19 @@ Suite *alloc_suite(void) {
 
   tcase_add_test(tc_core, basic_priv_alloc);
   tcase_add_test(tc_core, basic_shared_alloc);
+  tcase_add_test(tc_core, thread_arena_alloc);
+  tcase_add_test(tc_core, chained_alloc);
+  tcase_add_test(tc_core, free_realloc_alloc);
+  tcase_add_test(tc_core, bin_churn_alloc);
+  tcase_add_test(tc_core, realloc_shrink_grow_alloc);
+  tcase_add_test(tc_core, headerless_alloc);
+  tcase_add_test(tc_core, align_alloc);
+  tcase_add_test(tc_core, frame_linear_alloc);
+  tcase_add_test(tc_core, resident_alloc);
+  tcase_add_test(tc_core, memfd_shared_alloc);
+  tcase_add_test(tc_core, mem_stats_alloc);
+  tcase_add_test(tc_core, otba_grow_alloc);
+  tcase_add_test(tc_core, otba_bound_grow_alloc);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -124,18 +124,23 @@ START_TEST(test_vulkan_image_texture) {
   err = dlu_create_physical_device(app, cur_pd, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, &device_props, &device_feats);
   check_err(err, app, wc, NULL)
 
-  err = dlu_create_queue_families(app, cur_pd, VK_QUEUE_GRAPHICS_BIT);
+  err = dlu_create_queue_families(app, cur_pd, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
   check_err(err, app, wc, NULL)
 
+  /* The texture is streamed on a queue of the dedicated transfer family when the device has one */
+  uint32_t gfam_idx = app->pd_data[cur_pd].gfam_idx, tfam_idx = app->pd_data[cur_pd].tfam_idx;
   float queue_priorities[1] = {1.0};
-  VkDeviceQueueCreateInfo dqueue_create_info[1];
-  dqueue_create_info[0] = dlu_set_device_queue_info(0, app->pd_data[cur_pd].gfam_idx, 1, queue_priorities);
+  VkDeviceQueueCreateInfo dqueue_create_info[2];
+  uint32_t dqueue_cnt = 0;
+  dqueue_create_info[dqueue_cnt++] = dlu_set_device_queue_info(0, gfam_idx, 1, queue_priorities);
+  if (tfam_idx != UINT32_MAX && tfam_idx != gfam_idx)
+    dqueue_create_info[dqueue_cnt++] = dlu_set_device_queue_info(0, tfam_idx, 1, queue_priorities);
 
   device_feats.samplerAnisotropy = VK_TRUE;
-  err = dlu_create_logical_device(app, cur_pd, cur_ld, 0, ARR_LEN(dqueue_create_info), dqueue_create_info, &device_feats, ARR_LEN(device_extensions), device_extensions);
+  err = dlu_create_logical_device(app, cur_pd, cur_ld, 0, dqueue_cnt, dqueue_create_info, &device_feats, ARR_LEN(device_extensions), device_extensions);
   check_err(err, app, wc, NULL)
 
-  err = dlu_create_device_queue(app, cur_ld, 0, VK_QUEUE_GRAPHICS_BIT);
+  err = dlu_create_device_queue(app, cur_ld, 0, VK_QUEUE_GRAPHICS_BIT | ((tfam_idx != UINT32_MAX) ? VK_QUEUE_TRANSFER_BIT : 0));
   check_err(err, app, wc, NULL)
 
   /* Get debug functions for a given logical device */
@@ -218,28 +223,16 @@ START_TEST(test_vulkan_image_texture) {
   // result = ktxTexture_CreateFromMemory((unsigned char *) picture.bytes,  picture.byte_size, KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTexture);
 
   /**
-  * The buffer is a staging host visible memory buffer. That can be mapped.
-  * It's usable as a transfer source so that we can copy it to an image later on
-  * The VK_MEMORY_PROPERTY_HOST_COHERENT_BIT requests that the
-  * writes to the memory by the host are visible to the device
-  * (and vice-versa) without the need to flush memory caches.
+  * Pixels are copied into the upload engine's staging buffer right away. The copy
+  * runs on the transfer queue and the image is handed over to the graphics family
+  * in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, ready for fragment shader reads.
   */
-  err = dlu_create_vk_buffer(app, cur_ld, cur_bd, img_size, 0, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE,
-    0, NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-  );
-  if (err) {
-    stbi_image_free(pixels); pixels = NULL;
-    check_err(VK_TRUE, app, wc, NULL)
-  }
-
-  err = dlu_vk_map_mem(DLU_VK_BUFFER, app, cur_bd, img_size, pixels, 0, 0);
+  err = dlu_vk_upload_create(app, cur_ld, img_size);
   if (err) {
     stbi_image_free(pixels); pixels = NULL;
     check_err(VK_TRUE, app, wc, NULL)
   }
 
-  stbi_image_free(pixels); pixels = NULL;
-
   VkImageCreateInfo img_info = dlu_set_image_info(0, VK_IMAGE_TYPE_2D, VK_FORMAT_B8G8R8A8_UNORM, img_extent, 1, 1,
     VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
     VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_IMAGE_LAYOUT_UNDEFINED
@@ -249,79 +242,23 @@ START_TEST(test_vulkan_image_texture) {
   img_view_info.components = dlu_set_component_mapping(VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY);
 
   uint32_t cur_tex = 0;
-  err = dlu_create_texture_image(app, cur_ld, cur_tex, &img_info, &img_view_info, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-  check_err(err, app, wc, NULL)
-
-  VkCommandBuffer cmd_buff = dlu_exec_begin_single_time_cmd_buff(app, cur_pool);
-  check_err(!cmd_buff, app, wc, NULL)
-
-  app->dbg_utils_set_object_name(app->ld_data[cur_ld].device, &(VkDebugUtilsObjectNameInfoEXT) {
-      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-      .pNext = NULL,
-      .objectType = VK_OBJECT_TYPE_COMMAND_BUFFER,
-      .objectHandle = (uint64_t) cmd_buff,
-      .pObjectName = "VkPipelineBarrier Command Buffer"
-    }
-  ); 
-
-  app->dbg_utils_set_object_name(app->ld_data[cur_ld].device, &(VkDebugUtilsObjectNameInfoEXT) {
-      .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-      .pNext = NULL,
-      .objectType = VK_OBJECT_TYPE_IMAGE,
-      .objectHandle = (uint64_t) app->text_data[cur_tex].image,
-      .pObjectName = "VkPipelineBarrier Texture Image"
-    }
-  );
-
-  app->dbg_utils_cmd_begin(cmd_buff, &(VkDebugUtilsLabelEXT) {
-    .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-    .pNext = NULL,
-    .pLabelName = "Inside VkPipelineBarrier Command Buffer",
-    .color[0] = 0.0f, .color[1] = 0.0f, .color[2] = 0.0f, .color[3] = 0.0f
-  });
+  err = dlu_create_texture_image(app, cur_ld, cur_tex, &img_info, &img_view_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  if (err) {
+    stbi_image_free(pixels); pixels = NULL;
+    check_err(VK_TRUE, app, wc, NULL)
+  }
 
-  VkImageMemoryBarrier barrier = dlu_set_image_mem_barrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
-    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_QUEUE_FAMILY_IGNORED,
-    VK_QUEUE_FAMILY_IGNORED, app->text_data[cur_tex].image, img_sub_rr
+  uint64_t ticket = 0;
+  err = dlu_vk_upload_image(app, cur_ld, cur_tex, img_size, pixels, img_extent, img_sub_rr, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, &ticket
   );
-
-  /* Using image memory barrier to perform layout transitions */
-  dlu_exec_pipeline_barrier(VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier, cmd_buff);
-
-  /** 
-  * If one were to choose to map the jpg, png, etc.. directly into a textures bounded VkDeviceMemory (Staging Image)
-  * err = dlu_vk_map_mem(DLU_TEXT_VK_IMAGE, app, cur_tex, img_size, pixels, 0, 0);
-  * if (err) {
-  *   stbi_image_free(pixels); pixels = NULL;
-  *   check_err(VK_TRUE, app, wc, NULL)
-  * }
-  */
-
-  VkOffset3D offset3D = {0, 0, 0};
-  VkImageSubresourceLayers img_sub_rl = dlu_set_image_sub_resource_layers(VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1);
-
-  /* Specify what part of the buffer is copied to which part of the image */
-  VkBufferImageCopy region = dlu_set_buff_image_copy(0, 0, 0, img_sub_rl, offset3D, img_extent);
-
-  /* cur_bd: must be a valid VkBuffer that contains your image pixels. Now Copy pixels in VkBuffer over to VkImage */
-  dlu_exec_copy_buff_to_image(app, cur_bd, cur_tex, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, cmd_buff);
-
-  /**
-  * Allows for in shader sampling of a texture image,
-  * This is the last transition to run, to prepare for shader access
-  */
-  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  dlu_exec_pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier, cmd_buff);
-
-  app->dbg_utils_cmd_end(cmd_buff);
-
-  err = dlu_exec_end_single_time_cmd_buff(app, cur_pool, &cmd_buff);
+  stbi_image_free(pixels); pixels = NULL;
   check_err(err, app, wc, NULL)
 
-  /* Destroy staging buffer and memory as it is no longer needed */
-  dlu_vk_destroy(DLU_DESTROY_VK_BUFFER, app, cur_ld, app->buff_data[cur_bd].buff); app->buff_data[cur_bd].buff = VK_NULL_HANDLE;
-  dlu_vk_destroy(DLU_DESTROY_VK_MEMORY, app, cur_ld, app->buff_data[cur_bd].mem); app->buff_data[cur_bd].mem = VK_NULL_HANDLE;
+  /* Submits the batch, then blocks on its fence */
+  err = dlu_vk_upload_wait(app, cur_ld, ticket);
+  check_err(err, app, wc, NULL)
+  check_err(!dlu_vk_upload_done(app, cur_ld, ticket), app, wc, NULL)
 
   VkSamplerCreateInfo sampler = dlu_set_sampler_info(0, VK_FILTER_LINEAR, VK_FILTER_LINEAR, 0.0f, VK_SAMPLER_MIPMAP_MODE_LINEAR,
     VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, 16.0f, VK_TRUE, VK_FALSE,
@@ -568,6 +505,10 @@ START_TEST(test_vulkan_image_texture) {
   VkSemaphore acquire_sems[MAX_FRAMES], render_sems[MAX_FRAMES];
   VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+  /* Uniform buffer stays mapped, per frame updates are plain copies (flushed if non-coherent) */
+  void *ubo = dlu_vk_get_mapped(DLU_VK_BUFFER, app, cur_bd, offsets[1]);
+  check_err(!ubo, app, wc, NULL)
+
   for (uint32_t c = 0; c < 3000; c++) {
     /* set fence to signal state */
     err = dlu_vk_sync(DLU_VK_WAIT_RENDER_FENCE, app, cur_scd, cur_frame);
@@ -584,7 +525,8 @@ START_TEST(test_vulkan_image_texture) {
     dlu_set_matrix(DLU_MAT4_IDENTITY, ubd.model, NULL);
     dlu_set_rotate(DLU_AXIS_Z, ubd.model, ((float) time / convert) * angle, spin_up);
 
-    err = dlu_vk_map_mem(DLU_VK_BUFFER, app, cur_bd, sizeof(struct uniform_block_data), &ubd, offsets[1], 0);
+    memcpy(ubo, &ubd, sizeof(struct uniform_block_data));
+    err = dlu_vk_flush_mem(DLU_VK_BUFFER, app, cur_bd, offsets[1], sizeof(struct uniform_block_data));
     check_err(err, app, wc, NULL)
 
     /* set fence to unsignal state */
@@ -400,6 +400,10 @@ START_TEST(test_vulkan_rotate_rect) {
   VkSemaphore acquire_sems[MAX_FRAMES], render_sems[MAX_FRAMES];
   VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+  /* Uniform buffer stays mapped, per frame updates are plain copies (flushed if non-coherent) */
+  void *ubo = dlu_vk_get_mapped(DLU_VK_BUFFER, app, cur_bd, offsets[2]);
+  check_err(!ubo, app, wc, NULL)
+
   for (uint32_t c = 0; c < 3500; c++) {
     /* set fence to signal state */
     err = dlu_vk_sync(DLU_VK_WAIT_RENDER_FENCE, app, cur_scd, cur_frame);
@@ -416,7 +420,8 @@ START_TEST(test_vulkan_rotate_rect) {
     dlu_set_matrix(DLU_MAT4_IDENTITY, ubd.model, NULL);
     dlu_set_rotate(DLU_AXIS_Z, ubd.model, ((float) time / convert) * angle, spin_up);
 
-    err = dlu_vk_map_mem(DLU_VK_BUFFER, app, cur_bd, sizeof(struct uniform_block_data), &ubd, offsets[2], 0);
+    memcpy(ubo, &ubd, sizeof(struct uniform_block_data));
+    err = dlu_vk_flush_mem(DLU_VK_BUFFER, app, cur_bd, offsets[2], sizeof(struct uniform_block_data));
     check_err(err, app, wc, NULL)
 
     /* set fence to unsignal state */
@@ -42,6 +42,25 @@ static dlu_otma_mems ma = {
   .bd_cnt = 1, .ld_cnt = 1, .pd_cnt = 1
 };
 
+/* What record_square() needs to draw into whichever image's command buffer it's handed */
+struct square_draw {
+  VkViewport viewport;
+  uint32_t cur_gpd, cur_bd, index_count;
+  const VkDeviceSize *offsets;
+  uint32_t records; /* Times record_square() ran */
+};
+
+static void record_square(vkcomp *app, uint32_t cur_pool, uint32_t cur_buff, void *data) {
+  struct square_draw *sd = data;
+
+  dlu_exec_cmd_set_viewport(app, &sd->viewport, cur_pool, cur_buff, 0, 1);
+  dlu_bind_pipeline(app, cur_pool, cur_buff, sd->cur_gpd, 0, VK_PIPELINE_BIND_POINT_GRAPHICS);
+  dlu_bind_vertex_buff_to_cmd_buff(app, cur_pool, cur_buff, sd->cur_bd, 0, sd->offsets);
+  dlu_bind_index_buff_to_cmd_buff(app, cur_pool, cur_buff, sd->cur_bd, sd->offsets[1], VK_INDEX_TYPE_UINT16);
+  dlu_exec_cmd_draw_indexed(app, cur_pool, cur_buff, sd->index_count, 1, 0, sd->offsets[0], 0);
+  sd->records++;
+}
+
 static bool init_buffs(vkcomp *app) {
   bool err;
 
@@ -132,7 +151,7 @@ START_TEST(test_vulkan_rect) {
   VkExtent2D extent2D = dlu_choose_swap_extent(capabilities, WIDTH, HEIGHT);
   check_err(extent2D.width == UINT32_MAX, app, wc, NULL)
 
-  uint32_t cur_buff = 0, cur_scd = 0, cur_pool = 0, cur_gpd = 0, cur_bd = 0, cur_cmdd = 0;
+  uint32_t cur_scd = 0, cur_pool = 0, cur_gpd = 0, cur_bd = 0, cur_cmdd = 0;
   err = dlu_otba(DLU_SC_DATA_MEMS, app, cur_scd, capabilities.minImageCount);
   check_err(!err, app, wc, NULL)
 
@@ -149,7 +168,8 @@ START_TEST(test_vulkan_rect) {
   err = dlu_create_swap_chain(app, cur_ld, cur_scd, &swapchain_info, &img_view_info);
   check_err(err, app, wc, NULL)
 
-  err = dlu_create_cmd_pool(app, cur_ld, cur_scd, cur_cmdd, app->pd_data[cur_pd].gfam_idx, 0);
+  /* Buffers are re-recorded by dlu_exec_record_cached() whenever the scene is marked dirty */
+  err = dlu_create_cmd_pool(app, cur_ld, cur_scd, cur_cmdd, app->pd_data[cur_pd].gfam_idx, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
   check_err(err, app, wc, NULL)
 
   err = dlu_create_cmd_buffs(app, cur_pool, cur_scd, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
@@ -328,39 +348,66 @@ START_TEST(test_vulkan_rect) {
   uint32_t uint32[4] = {0.0f, 0.0f, 0.0f, 1.0f};
   VkClearValue clear_value = dlu_set_clear_value(float32, int32, uint32, 0.0f, 0);
 
-  /* Set command buffers into recording state */
-  err = dlu_exec_begin_cmd_buffs(app, cur_pool, cur_scd, 0, NULL);
-  check_err(err, app, wc, NULL)
-
-  /* Drawing will start when you begin a render pass */
-  dlu_exec_begin_render_pass(app, cur_pool, cur_scd, cur_gpd, 0, 0, extent2D.width, extent2D.height, 1, &clear_value, VK_SUBPASS_CONTENTS_INLINE);
-  dlu_exec_cmd_set_viewport(app, &viewport, cur_pool, cur_buff, 0, 1);
-  dlu_bind_pipeline(app, cur_pool, cur_buff, cur_gpd, 0, VK_PIPELINE_BIND_POINT_GRAPHICS);
-  dlu_bind_vertex_buff_to_cmd_buff(app, cur_pool, cur_buff, cur_bd, 0, offsets);
-  dlu_bind_index_buff_to_cmd_buff(app, cur_pool, cur_buff, cur_bd, offsets[1], VK_INDEX_TYPE_UINT16);
-  dlu_exec_cmd_draw_indexed(app, cur_pool, cur_buff, index_count, 1, 0, offsets[0], 0);
-
-  dlu_exec_stop_render_pass(app, cur_pool, cur_scd);
-  err = dlu_exec_stop_cmd_buffs(app, cur_pool, cur_scd);
-  check_err(err, app, wc, NULL)
-
   VkPipelineStageFlags pipe_stage_flags[1] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-  VkSemaphore acquire_sems[1] = {app->sc_data[cur_scd].syncs[0].sem.image};
-  VkSemaphore render_sems[1] = {app->sc_data[cur_scd].syncs[0].sem.render};
-  VkCommandBuffer cmd_buffs[1] = {app->cmd_data[cur_pool].cmd_buffs[cur_buff]};
-
-  uint32_t cur_img, cur_frame = 0;
-  err = dlu_acquire_sc_image_index(app, cur_scd, cur_frame, &cur_img);
-  check_err(err, app, wc, NULL)
-
-  /* set fence to unsignal state */
-  err = dlu_vk_sync(DLU_VK_RESET_RENDER_FENCE, app, cur_scd, 0);
-  check_err(err, app, wc, NULL)
+  VkRect2D render_area = {{0, 0}, extent2D};
+  VkCommandBuffer cmd_buff = VK_NULL_HANDLE;
+
+  struct square_draw sd = { .viewport = viewport, .cur_gpd = cur_gpd, .cur_bd = cur_bd, .index_count = index_count, .offsets = offsets };
+  uint32_t cur_img, cur_frame = 0, sic = app->sc_data[cur_scd].sic;
+  uint32_t fresh = 0; /* Images acquired for the first time since the scene was last marked dirty */
+  bool seen[sic];
+  memset(seen, 0, sizeof(seen));
+
+  /* Image whose submit last waited on a frame's acquire semaphore, its fence tells when it's free */
+  uint32_t sem_owner[sic];
+  for (uint32_t i = 0; i < sic; i++) sem_owner[i] = UINT32_MAX;
+
+  for (uint32_t c = 0; c < 8 * sic; c++) {
+    /* Half way through pretend the scene changed, every image must get recorded once more */
+    if (c == 4 * sic) {
+      check_err(sd.records != fresh, app, wc, NULL)
+      dlu_exec_mark_dirty(app, cur_pool);
+      memset(seen, 0, sizeof(seen));
+      sd.records = fresh = 0;
+    }
+
+    /**
+    * Image acquire semaphores rotate per frame, everything else belongs to the image.
+    * The semaphore can only be signaled again once the submit that waited on it ran
+    */
+    if (sem_owner[cur_frame] != UINT32_MAX) {
+      err = dlu_vk_sync(DLU_VK_WAIT_RENDER_FENCE, app, cur_scd, sem_owner[cur_frame]);
+      check_err(err, app, wc, NULL)
+    }
+
+    VkSemaphore acquire_sems[1] = {app->sc_data[cur_scd].syncs[cur_frame].sem.image};
+    err = dlu_acquire_sc_image_index(app, cur_scd, cur_frame, &cur_img);
+    check_err(err, app, wc, NULL)
+
+    if (!seen[cur_img]) { seen[cur_img] = true; fresh++; }
+
+    err = dlu_exec_record_cached(app, cur_pool, cur_scd, cur_gpd, cur_img, render_area, 1, &clear_value, record_square, &sd, &cmd_buff);
+    check_err(err, app, wc, NULL)
+
+    /* set fence to unsignal state */
+    err = dlu_vk_sync(DLU_VK_RESET_RENDER_FENCE, app, cur_scd, cur_img);
+    check_err(err, app, wc, NULL)
+
+    VkSemaphore render_sems[1] = {app->sc_data[cur_scd].syncs[cur_img].sem.render};
+    err = dlu_queue_graphics_queue(app, cur_scd, cur_img, 1, &cmd_buff, 1, acquire_sems, pipe_stage_flags, 1, render_sems);
+    check_err(err, app, wc, NULL)
+    sem_owner[cur_frame] = cur_img;
+
+    err = dlu_queue_present_queue(app, cur_ld, 1, render_sems, 1, &app->sc_data[cur_scd].swap_chain, &cur_img, NULL);
+    check_err(err, app, wc, NULL)
+
+    cur_frame = (cur_frame + 1) % sic;
+  }
 
-  err = dlu_queue_graphics_queue(app, cur_scd, 0, 1, cmd_buffs, 1, acquire_sems, pipe_stage_flags, 1, render_sems);
-  check_err(err, app, wc, NULL)
+  /* Replayed frames never called record_square() */
+  check_err(sd.records != fresh, app, wc, NULL)
 
-  err = dlu_queue_present_queue(app, cur_ld, 1, render_sems, 1, &app->sc_data[cur_scd].swap_chain, &cur_buff, NULL);
+  err = dlu_vk_sync(DLU_VK_WAIT_RENDER_FENCE, app, cur_scd, cur_img);
   check_err(err, app, wc, NULL)
 
   sleep(1);
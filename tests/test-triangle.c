@@ -338,7 +338,7 @@ START_TEST(test_vulkan_client_create) {
 
   /* Destroy staging buffer as it is no longer needed */
   dlu_vk_destroy(DLU_DESTROY_VK_BUFFER, app, cur_ld, app->buff_data[cur_bd-2].buff); app->buff_data[cur_bd-2].buff = VK_NULL_HANDLE;
-  dlu_vk_destroy(DLU_DESTROY_VK_MEMORY, app, cur_ld, app->buff_data[cur_bd-2].mem); app->buff_data[cur_bd-2].mem = VK_NULL_HANDLE;
+  dlu_vk_mem_free(app, cur_ld, app->buff_data[cur_bd-2].mem, &app->buff_data[cur_bd-2].sub); app->buff_data[cur_bd-2].mem = VK_NULL_HANDLE;
 
   float float32[4] = {0.0f, 0.0f, 0.0f, 1.0f};
   int32_t int32[4] = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -136,6 +136,10 @@ START_TEST(test_set_logical_device) {
   err = dlu_otba(DLU_LD_DATA, app, INDEX_IGNORE, 1);
   if (!err) ck_abort_msg(NULL);
 
+  /* Account driver host allocations, command and object scopes come from a 1MB arena */
+  err = dlu_vk_host_alloc_create(app, 1 << 20, 0);
+  check_err(err, app, NULL, NULL)
+
   err = dlu_create_instance(app, "Set Logical", "No Engine", 1, enabled_validation_layers, 4, instance_extensions);
   check_err(err, app, NULL, NULL)
 
@@ -166,6 +170,388 @@ START_TEST(test_set_logical_device) {
   err = dlu_create_device_queue(app, 0, 0, VK_QUEUE_GRAPHICS_BIT);
   check_err(err, app, NULL, NULL)
 
+  dlu_vk_host_alloc_stats stats;
+  ck_assert(dlu_vk_host_alloc_get_stats(app, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE, &stats));
+  ck_assert_uint_gt(stats.alloc_cnt, 0);
+  ck_assert_uint_le(stats.used, stats.peak);
+  dlu_vk_host_alloc_print_stats(app);
+
+  FREEME(app, NULL)
+} END_TEST;
+
+START_TEST(test_timeline_cross_queue) {
+  VkResult err;
+  dlu_log_me(DLU_WARNING, "SIXTH TEST");
+
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .ld_cnt = 1, .pd_cnt = 1 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_init_vk();
+  check_err(!app, app, NULL, NULL)
+
+  err = dlu_otba(DLU_PD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_LD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_create_instance(app, "Timeline", "No Engine", 1, enabled_validation_layers, 4, instance_extensions);
+  check_err(err, app, NULL, NULL)
+
+  VkPhysicalDeviceProperties device_props;
+  VkPhysicalDeviceFeatures device_feats;
+  err = dlu_create_physical_device(app, 0, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, &device_props, &device_feats);
+  check_err(err, app, NULL, NULL)
+
+  /* No surface to present to, so compute stands in for graphics */
+  err = dlu_create_queue_families(app, 0, VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+  check_err(err, app, NULL, NULL)
+
+  uint32_t cfam_idx = app->pd_data[0].cfam_idx, tfam_idx = app->pd_data[0].tfam_idx;
+  float queue_priorities[1] = {1.0};
+  VkDeviceQueueCreateInfo dqueue_create_info[2];
+  dqueue_create_info[0] = dlu_set_device_queue_info(0, cfam_idx, 1, queue_priorities);
+  dqueue_create_info[1] = dlu_set_device_queue_info(0, tfam_idx, 1, queue_priorities);
+
+  /* Without a dedicated transfer family both queue types share one queue */
+  const char *timeline_extensions[] = { VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME };
+  err = dlu_create_logical_device(app, 0, 0, 0, (tfam_idx != cfam_idx) ? 2 : 1, dqueue_create_info, &device_feats, ARR_LEN(timeline_extensions), timeline_extensions);
+  check_err(err, app, NULL, NULL)
+
+  err = dlu_create_device_queue(app, 0, 0, VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+  check_err(err, app, NULL, NULL)
+
+  err = dlu_vk_timeline_create(app, 0);
+  check_err(err, app, NULL, NULL)
+
+  /* Empty submissions still signal, compute may only start once the transfer point is reached */
+  uint64_t tpoint = 0, cpoint = 0;
+  err = dlu_vk_timeline_submit(app, 0, DLU_VK_TRANSFER_QUEUE, 0, NULL, 0, NULL, NULL, &tpoint);
+  check_err(err, app, NULL, NULL)
+
+  dlu_vk_timeline_point wait = { .queue = DLU_VK_TRANSFER_QUEUE, .value = tpoint };
+  VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  err = dlu_vk_timeline_submit(app, 0, DLU_VK_COMPUTE_QUEUE, 0, NULL, 1, &wait, &wait_stage, &cpoint);
+  check_err(err, app, NULL, NULL)
+
+  ck_assert_int_eq(tpoint, 1);
+  ck_assert_int_eq(cpoint, dlu_vk_timeline_last(app, 0, DLU_VK_COMPUTE_QUEUE));
+
+  /* Nothing ever signals the point after cpoint */
+  dlu_vk_timeline_point never = { .queue = DLU_VK_COMPUTE_QUEUE, .value = cpoint + 1 };
+  ck_assert_int_eq(dlu_vk_timeline_wait(app, 0, 1, &never, 0), VK_TIMEOUT);
+
+  dlu_vk_timeline_point done = { .queue = DLU_VK_COMPUTE_QUEUE, .value = cpoint };
+  err = dlu_vk_timeline_wait(app, 0, 1, &done, UINT64_MAX);
+  check_err(err, app, NULL, NULL)
+
+  /* Compute finishing implies the transfer it waited on finished too */
+  ck_assert_uint_ge(dlu_vk_timeline_completed(app, 0, DLU_VK_TRANSFER_QUEUE), tpoint);
+  ck_assert_uint_ge(dlu_vk_timeline_completed(app, 0, DLU_VK_COMPUTE_QUEUE), cpoint);
+
+  FREEME(app, NULL)
+} END_TEST;
+
+/* Counts the evictions dlu_vk_mem_alloc() asks for, the default policy picks the victims */
+static bool count_evictions(vkcomp *app, uint32_t cur_ld, uint32_t heap, uint32_t type_idx, bool linear, VkDeviceSize size, void *data) {
+  bool evicted = dlu_vk_evict_lru_texture(app, cur_ld, heap, type_idx, linear, size, NULL);
+  if (evicted) (*(uint32_t *) data)++;
+  return evicted;
+}
+
+START_TEST(test_texture_eviction) {
+  VkResult err;
+  dlu_log_me(DLU_WARNING, "SEVENTH TEST");
+
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .ld_cnt = 1, .pd_cnt = 1, .td_cnt = 4, .bd_cnt = 1 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_init_vk();
+  check_err(!app, app, NULL, NULL)
+
+  err = dlu_otba(DLU_PD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_LD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_TEXT_DATA, app, INDEX_IGNORE, 4);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_create_instance(app, "Eviction", "No Engine", 1, enabled_validation_layers, 4, instance_extensions);
+  check_err(err, app, NULL, NULL)
+
+  VkPhysicalDeviceProperties device_props;
+  VkPhysicalDeviceFeatures device_feats;
+  err = dlu_create_physical_device(app, 0, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, &device_props, &device_feats);
+  check_err(err, app, NULL, NULL)
+
+  /* Nothing is submitted, any queue makes a device */
+  err = dlu_create_queue_families(app, 0, VK_QUEUE_COMPUTE_BIT);
+  check_err(err, app, NULL, NULL)
+
+  float queue_priorities[1] = {1.0};
+  VkDeviceQueueCreateInfo dqueue_create_info[1];
+  dqueue_create_info[0] = dlu_set_device_queue_info(0, app->pd_data[0].cfam_idx, 1, queue_priorities);
+
+  err = dlu_create_logical_device(app, 0, 0, 0, ARR_LEN(dqueue_create_info), dqueue_create_info, &device_feats, 0, NULL);
+  check_err(err, app, NULL, NULL)
+
+  uint32_t evictions = 0;
+  dlu_vk_mem_set_evict_hook(app, 0, count_evictions, &evictions);
+
+  VkComponentMapping comp_map = dlu_set_component_mapping(VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A);
+  VkImageSubresourceRange img_sub_rr = dlu_set_image_sub_resource_range(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1);
+  VkImageViewCreateInfo img_view_info = dlu_set_image_view_info(0, VK_NULL_HANDLE, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM, comp_map, img_sub_rr);
+
+  /* 4MB textures share a pool block, 64MB ones get memory of their own */
+  VkExtent3D small_extent = {1024, 1024, 1}, large_extent = {4096, 4096, 1};
+  VkImageCreateInfo small_info = dlu_set_image_info(0, VK_IMAGE_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM, small_extent, 1, 1,
+    VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_IMAGE_LAYOUT_UNDEFINED
+  );
+  VkImageCreateInfo large_info = small_info;
+  large_info.extent = large_extent;
+
+  for (uint32_t i = 0; i < 2; i++) {
+    err = dlu_create_texture_image(app, 0, i, &small_info, &img_view_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    check_err(err, app, NULL, NULL)
+    dlu_vk_touch_texture(app, i);
+  }
+
+  /* Long unused, nothing is in flight */
+  for (uint32_t i = 0; i < 2 * DLU_VK_EVICT_FRAME_LAG; i++) dlu_vk_mem_next_frame(app, 0);
+
+  /* Any new VkDeviceMemory object goes over budget from here on */
+  VkDeviceSize usage = 0, budget = 0;
+  err = dlu_vk_mem_get_budget(app, 0, app->text_data[0].sub.heap, &usage, &budget);
+  check_err(err, app, NULL, NULL)
+  dlu_vk_mem_set_budget(app, 0, usage);
+
+  /* Freeing an image range in a partly used block can't make room for a buffer */
+  err = dlu_create_vk_buffer(app, 0, 0, 4096, 0, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+  check_err(err, app, NULL, NULL)
+  ck_assert_int_eq(evictions, 0);
+  ck_assert(!dlu_vk_texture_evicted(app, 0) && !dlu_vk_texture_evicted(app, 1));
+
+  err = dlu_create_texture_image(app, 0, 2, &large_info, &img_view_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  check_err(err, app, NULL, NULL)
+  ck_assert_int_eq(evictions, 0);
+  dlu_vk_touch_texture(app, 2);
+  for (uint32_t i = 0; i < 2 * DLU_VK_EVICT_FRAME_LAG; i++) dlu_vk_mem_next_frame(app, 0);
+
+  /* Only texture 2 gives a whole VkDeviceMemory object back, the small ones stay */
+  err = dlu_create_texture_image(app, 0, 3, &large_info, &img_view_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  check_err(err, app, NULL, NULL)
+  ck_assert_int_eq(evictions, 1);
+  ck_assert(dlu_vk_texture_evicted(app, 2));
+  ck_assert(!dlu_vk_texture_evicted(app, 0) && !dlu_vk_texture_evicted(app, 1) && !dlu_vk_texture_evicted(app, 3));
+
+  FREEME(app, NULL)
+} END_TEST;
+
+START_TEST(test_exec_batch) {
+  VkResult err;
+  dlu_log_me(DLU_WARNING, "EIGHTH TEST");
+
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .ld_cnt = 1, .pd_cnt = 1, .scd_cnt = 1, .cmdd_cnt = 1, .bd_cnt = 2 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_init_vk();
+  check_err(!app, app, NULL, NULL)
+
+  err = dlu_otba(DLU_PD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_LD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_SC_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_CMD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 2);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_create_instance(app, "Batch", "No Engine", 1, enabled_validation_layers, 4, instance_extensions);
+  check_err(err, app, NULL, NULL)
+
+  VkPhysicalDeviceProperties device_props;
+  VkPhysicalDeviceFeatures device_feats;
+  err = dlu_create_physical_device(app, 0, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, &device_props, &device_feats);
+  check_err(err, app, NULL, NULL)
+
+  err = dlu_create_queue_families(app, 0, VK_QUEUE_COMPUTE_BIT);
+  check_err(err, app, NULL, NULL)
+
+  float queue_priorities[1] = {1.0};
+  VkDeviceQueueCreateInfo dqueue_create_info[1];
+  dqueue_create_info[0] = dlu_set_device_queue_info(0, app->pd_data[0].cfam_idx, 1, queue_priorities);
+
+  err = dlu_create_logical_device(app, 0, 0, 0, ARR_LEN(dqueue_create_info), dqueue_create_info, &device_feats, 0, NULL);
+  check_err(err, app, NULL, NULL)
+
+  err = dlu_create_device_queue(app, 0, 0, VK_QUEUE_COMPUTE_BIT);
+  check_err(err, app, NULL, NULL)
+
+  /* No surface means no graphics family, batches go to the compute queue which copies just as well */
+  app->ld_data[0].graphics = app->ld_data[0].compute;
+
+  /* Command pools are sized by a swap chain, there's none to create here */
+  app->sc_data[0].sic = 1;
+  err = dlu_create_cmd_pool(app, 0, 0, 0, app->pd_data[0].cfam_idx, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+  check_err(err, app, NULL, NULL)
+
+  const VkDeviceSize chunk = 256, chunk_cnt = 4;
+  for (uint32_t i = 0; i < 2; i++) {
+    err = dlu_create_vk_buffer(app, 0, i, chunk * chunk_cnt, 0, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    check_err(err, app, NULL, NULL)
+  }
+
+  uint8_t *src = dlu_vk_get_mapped(DLU_VK_BUFFER, app, 0, 0), *dst = dlu_vk_get_mapped(DLU_VK_BUFFER, app, 1, 0);
+  check_err((!src || !dst), app, NULL, NULL)
+
+  /* More batches than slots, the later ones reuse the command buffers of the first */
+  uint64_t ticket = 0;
+  for (uint32_t b = 0; b < 2 * DLU_EXEC_BATCH_CNT; b++) {
+    memset(src, b + 1, chunk * chunk_cnt);
+
+    VkCommandBuffer cmd_buff = dlu_exec_begin_batch(app, 0);
+    check_err(!cmd_buff, app, NULL, NULL)
+
+    /* Every copy and barrier lands in the same command buffer */
+    for (uint32_t i = 0; i < chunk_cnt; i++) {
+      ck_assert_ptr_eq(dlu_exec_begin_batch(app, 0), cmd_buff);
+      dlu_exec_copy_buffer(app, 0, 1, i * chunk, (chunk_cnt - 1 - i) * chunk, chunk, cmd_buff);
+    }
+
+    VkBufferMemoryBarrier barrier = dlu_set_buffer_mem_barrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+      VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, app->buff_data[1].buff, 0, VK_WHOLE_SIZE
+    );
+    dlu_exec_pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &barrier, 0, NULL, cmd_buff);
+
+    err = dlu_exec_submit_batch(app, 0, &ticket);
+    check_err(err, app, NULL, NULL)
+    ck_assert_uint_eq(ticket, b + 1);
+
+    /* Polling never blocks, the batch is done at some point */
+    while (!dlu_exec_batch_done(app, 0, ticket));
+
+    err = dlu_exec_wait_batch(app, 0, ticket);
+    check_err(err, app, NULL, NULL)
+
+    for (uint32_t i = 0; i < chunk * chunk_cnt; i++)
+      ck_assert_uint_eq(dst[i], b + 1);
+  }
+
+  /* Nothing recorded, the newest ticket is handed back */
+  uint64_t last = 0;
+  err = dlu_exec_submit_batch(app, 0, &last);
+  check_err(err, app, NULL, NULL)
+  ck_assert_uint_eq(last, ticket);
+
+  FREEME(app, NULL)
+} END_TEST;
+
+START_TEST(test_bindless) {
+  VkResult err;
+  dlu_log_me(DLU_WARNING, "NINTH TEST");
+
+  dlu_otma_mems ma = { .vkcomp_cnt = 1, .ld_cnt = 1, .pd_cnt = 1, .td_cnt = 1, .bd_cnt = 1 };
+  if (!dlu_otma(DLU_LARGE_BLOCK_PRIV, ma)) ck_abort_msg(NULL);
+
+  vkcomp *app = dlu_init_vk();
+  check_err(!app, app, NULL, NULL)
+
+  err = dlu_otba(DLU_PD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_LD_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_TEXT_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  err = dlu_otba(DLU_BUFF_DATA, app, INDEX_IGNORE, 1);
+  if (!err) ck_abort_msg(NULL);
+
+  /* Device features are queried before they're enabled, device address allocations need device groups */
+  const char *bindless_instance_extensions[] = {
+    VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
+    VK_KHR_DEVICE_GROUP_CREATION_EXTENSION_NAME,
+    VK_EXT_DEBUG_UTILS_EXTENSION_NAME
+  };
+
+  err = dlu_create_instance(app, "Bindless", "No Engine", 1, enabled_validation_layers, ARR_LEN(bindless_instance_extensions), bindless_instance_extensions);
+  check_err(err, app, NULL, NULL)
+
+  VkPhysicalDeviceProperties device_props;
+  VkPhysicalDeviceFeatures device_feats;
+  err = dlu_create_physical_device(app, 0, VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, &device_props, &device_feats);
+  check_err(err, app, NULL, NULL)
+
+  err = dlu_create_queue_families(app, 0, VK_QUEUE_COMPUTE_BIT);
+  check_err(err, app, NULL, NULL)
+
+  float queue_priorities[1] = {1.0};
+  VkDeviceQueueCreateInfo dqueue_create_info[1];
+  dqueue_create_info[0] = dlu_set_device_queue_info(0, app->pd_data[0].cfam_idx, 1, queue_priorities);
+
+  const char *bindless_extensions[] = {
+    VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+    VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+    VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
+    VK_KHR_DEVICE_GROUP_EXTENSION_NAME
+  };
+
+  err = dlu_create_logical_device(app, 0, 0, 0, ARR_LEN(dqueue_create_info), dqueue_create_info, &device_feats, ARR_LEN(bindless_extensions), bindless_extensions);
+  check_err(err, app, NULL, NULL)
+
+  err = dlu_vk_bindless_create(app, 0, 3, VK_SHADER_STAGE_FRAGMENT_BIT);
+  check_err(err, app, NULL, NULL)
+
+  VkComponentMapping comp_map = dlu_set_component_mapping(VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A);
+  VkImageSubresourceRange img_sub_rr = dlu_set_image_sub_resource_range(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1);
+  VkImageViewCreateInfo img_view_info = dlu_set_image_view_info(0, VK_NULL_HANDLE, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM, comp_map, img_sub_rr);
+  VkImageCreateInfo img_info = dlu_set_image_info(0, VK_IMAGE_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM, (VkExtent3D) {16, 16, 1}, 1, 1,
+    VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_IMAGE_LAYOUT_UNDEFINED
+  );
+
+  err = dlu_create_texture_image(app, 0, 0, &img_info, &img_view_info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  check_err(err, app, NULL, NULL)
+
+  VkSamplerCreateInfo sampler = dlu_set_sampler_info(0, VK_FILTER_LINEAR, VK_FILTER_LINEAR, 0.0f, VK_SAMPLER_MIPMAP_MODE_LINEAR,
+    VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT, 1.0f, VK_FALSE, VK_FALSE,
+    VK_COMPARE_OP_ALWAYS, 0.0f, 0.0f, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE
+  );
+
+  err = dlu_create_texture_sampler(app, 0, &sampler);
+  check_err(err, app, NULL, NULL)
+
+  /* One texture may sit in any amount of slots */
+  for (uint32_t i = 0; i < 3; i++)
+    ck_assert_uint_eq(dlu_vk_bindless_add_texture(app, 0, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL), i);
+  ck_assert_uint_eq(dlu_vk_bindless_add_texture(app, 0, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL), UINT32_MAX);
+
+  /* Removing a slot twice gives it back once */
+  dlu_vk_bindless_remove(app, 0, 1);
+  dlu_vk_bindless_remove(app, 0, 1);
+  ck_assert_uint_eq(dlu_vk_bindless_add_texture(app, 0, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL), 1);
+  ck_assert_uint_eq(dlu_vk_bindless_add_texture(app, 0, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL), UINT32_MAX);
+
+  /* Vertex data is read through its address */
+  err = dlu_create_vk_buffer(app, 0, 0, 4096, 0, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+    VK_SHARING_MODE_EXCLUSIVE, 0, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+  );
+  check_err(err, app, NULL, NULL)
+  ck_assert(app->buff_data[0].addr != 0);
+
   FREEME(app, NULL)
 } END_TEST;
 
@@ -183,6 +569,10 @@ Suite *vulkan_suite(void) {
   tcase_add_test(tc_core, test_create_instance);
   tcase_add_test(tc_core, test_enumerate_device);
   tcase_add_test(tc_core, test_set_logical_device);
+  tcase_add_test(tc_core, test_timeline_cross_queue);
+  tcase_add_test(tc_core, test_texture_eviction);
+  tcase_add_test(tc_core, test_exec_batch);
+  tcase_add_test(tc_core, test_bindless);
   suite_add_tcase(s, tc_core);
 
   return s;